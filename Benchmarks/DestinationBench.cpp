@@ -0,0 +1,100 @@
+//"dests"/"nodests" matching: the rfind scan validizeSid used to run over each entry, and packed DestinationPrefixes
+//Usage: DestinationBench [entries] [iterations]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <boost/format.hpp>
+#include "Ruleset.hpp"
+
+using namespace std;
+
+static volatile size_t sink;
+
+//Runs f over every destination iterations times, returns nanoseconds per destination
+template <class F>
+static double timeDests(const vector<string>& dests, size_t iterations, F f) {
+	size_t matched = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (size_t i = 0; i < iterations; i++) {
+		for (const string& dest : dests) {
+			matched += f(dest);
+		}
+	}
+
+	double elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+	sink = matched;
+	return elapsed / (iterations * dests.size());
+}
+
+static string randomCode(mt19937& rng, size_t len) {
+	string out;
+	for (size_t i = 0; i < len; i++) {
+		out += (char)('A' + rng() % 26);
+	}
+	return out;
+}
+
+int main(int argc, char** argv) {
+	size_t entries = argc > 1 ? strtoul(argv[1], nullptr, 10) : 400;
+	size_t iterations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+	mt19937 rng(1);
+
+	//Prefixes of 1 to 4 characters, with a few longer ones as written by some facilities
+	vector<string> prefixes;
+	string json = "[{\"icao\": \"EGLL\", \"sids\": [{\"point\": \"LAM\", \"constraints\": [{\"dests\": [";
+	for (size_t i = 0; i < entries; i++) {
+		prefixes.push_back(randomCode(rng, i % 20 == 0 ? 5 : 1 + (i % 4)));
+		json += (i ? ", \"" : "\"") + prefixes.back() + "\"";
+	}
+	json += "]}]}]}]";
+
+	SidRuleset rules;
+	vector<RulesetIssue> issues;
+	if (!compileRulesetStream(&json[0], rules, issues) || rules.find("EGLL") == nullptr) {
+		cerr << "Could not compile the generated rules\n";
+		return 1;
+	}
+	const DestinationPrefixes& compiled = rules.find("EGLL")->sids[0].constraints[0].destPrefixes;
+
+	//Mostly misses, which scan the whole list
+	vector<string> dests;
+	for (size_t i = 0; i < 64; i++) {
+		dests.push_back(randomCode(rng, 4));
+	}
+
+	double scanned = timeDests(dests, iterations, [&prefixes](const string& dest) {
+		for (const string& each : prefixes) {
+			if (dest.rfind(each, 0) != string::npos) {
+				return true;
+			}
+		}
+		return false;
+	});
+
+	double packed = timeDests(dests, iterations * 20, [&compiled](const string& dest) {
+		return compiled.matches(packIcao(dest), dest);
+	});
+
+	//Both must agree before their timings mean anything
+	for (const string& dest : dests) {
+		bool scan = false;
+		for (const string& each : prefixes) {
+			scan = scan || dest.rfind(each, 0) != string::npos;
+		}
+
+		if (scan != compiled.matches(packIcao(dest), dest)) {
+			cerr << "Mismatch for " << dest << "\n";
+			return 1;
+		}
+	}
+
+	cout << boost::format("%i entries\n") % entries;
+	cout << boost::format("rfind scan:          %8.1f ns/destination\n") % scanned;
+	cout << boost::format("DestinationPrefixes: %8.1f ns/destination\n") % packed;
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+//Speed/level group matching: the regex validizeSid used to build per call, the same regex built once, and parseSpeedLevel
+//Usage: SpeedLevelBench [iterations]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <regex>
+#include <chrono>
+#include <cstdlib>
+#include <boost/format.hpp>
+#include "RouteParser.hpp"
+
+using namespace std;
+
+//Typical groups after a "/", valid and invalid
+static const vector<string> tokens = { "N0450F350", "M082F370", "K0830S1130", "N0250A045", "N045F350", "N0450F35", "LAM", "N0450F350F390" };
+
+static volatile size_t sink;
+
+//Runs f over every token iterations times, returns nanoseconds per token
+template <class F>
+static double timeTokens(size_t iterations, F f) {
+	size_t matched = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	for (size_t i = 0; i < iterations; i++) {
+		for (const string& token : tokens) {
+			matched += f(token);
+		}
+	}
+
+	double elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+	sink = matched;
+	return elapsed / (iterations * tokens.size());
+}
+
+int main(int argc, char** argv) {
+	size_t iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+	const char* pattern = "(N|M|K)[0-9]{3,4}(A|F)[0-9]{3}$";
+
+	double built = timeTokens(iterations / 20 + 1, [pattern](const string& token) {
+		regex lvl_chng(pattern);
+		return regex_match(token, lvl_chng);
+	});
+
+	regex prebuilt(pattern);
+	double reused = timeTokens(iterations, [&prebuilt](const string& token) {
+		return regex_match(token, prebuilt);
+	});
+
+	double parsed = timeTokens(iterations * 10, [](const string& token) {
+		SpeedLevel out;
+		return parseSpeedLevel(token.c_str(), token.size(), out);
+	});
+
+	cout << boost::format("regex built per token: %10.1f ns/token\n") % built;
+	cout << boost::format("regex built once:      %10.1f ns/token\n") % reused;
+	cout << boost::format("parseSpeedLevel:       %10.1f ns/token\n") % parsed;
+
+	return 0;
+}
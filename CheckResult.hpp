@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include "Ruleset.hpp"
+#include "RouteParser.hpp"
+
+//Outcome of the SID lookup in a flight plan check
+enum class SidStatus {
+	Valid,
+	AirportNotFound,	//Origin not in database
+	NoneSet,			//No SID assigned, or SID name without a suffix
+	WrongFirstFix,		//Route does not start at the SID's final fix
+	NoneDefined,		//Origin has no SIDs
+	NotFound			//SID not in database
+};
+
+//Outcome of an individual check
+enum class CheckStatus {
+	NotChecked,
+	Passed,
+	Failed
+};
+
+//Result of a flight plan check. Text output is only rendered from it on request (CVFPCPlugin::renderCheck).
+struct CheckResult {
+	bool passed = false;
+	SidStatus sid = SidStatus::Valid;
+	RouteError syntax = RouteError::None;
+
+	CheckStatus destination = CheckStatus::NotChecked;
+	CheckStatus route = CheckStatus::NotChecked;
+	CheckStatus nav = CheckStatus::NotChecked;
+	CheckStatus level = CheckStatus::NotChecked;		//Min/Max Level
+	CheckStatus direction = CheckStatus::NotChecked;
+	CheckStatus suffix = CheckStatus::NotChecked;
+	CheckStatus restrictions = CheckStatus::NotChecked;
+
+	std::shared_ptr<const SidRuleset> rules;	//Rules the check ran against, which sidIndex and survivors refer to
+	size_t sidIndex = 0;		//Index into AirportRules::sids, if sid is Valid
+	int round = 0;				//Constraint round that eliminated every constraint, ConstraintRounds if all passed
+	ConstraintMask survivors;	//Constraints left before that round
+	bool sidwide = true;		//SID-wide restrictions permit the flight
+	bool sidLevel = false;		//suffix/restrictions were decided by the SID-wide restrictions (sidFails) rather than the surviving constraints (restFails)
+	bool sidFails[3] = { false, false, false };		//0 = Suffix, 1 = Aircraft/Engines, 2 = Date/Time Restrictions
+	bool restFails[3] = { false, false, false };
+};
@@ -0,0 +1,453 @@
+#include "FlightPlanCheck.hpp"
+#include <cctype>
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+
+//Splits a SID name into its cleaned name, first waypoint and suffix
+void splitSid(const AirportRules& airport, const string& sidName, string& sid, string& first_wp, string& sid_suffix) {
+	sid = sidName; boost::to_upper(sid);
+
+	// Remove any # characters from SID name
+	boost::erase_all(sid, "#");
+
+	first_wp.clear();
+	sid_suffix.clear();
+
+	if (!sid.length()) {
+		return;
+	}
+
+	map<string, string>::const_iterator alias = airport.sidAliases.find(sid);
+	if (alias != airport.sidAliases.end()) {
+		first_wp = alias->second;
+		sid_suffix = sid;
+	}
+	else {
+		first_wp = sid.substr(0, sid.find_first_of("0123456789"));
+		if (0 != first_wp.length())
+			boost::to_upper(first_wp);
+
+		if (first_wp.length() != sid.length()) {
+			sid_suffix = sid.substr(sid.find_first_of("0123456789"), sid.length());
+			boost::to_upper(sid_suffix);
+		}
+	}
+}
+
+//Checks whether a route starts with any of the patterns
+static bool routeContains(const RouteTokenIds& rte, const vector<RoutePattern>& valid) {
+	for (const RoutePattern& current : valid) {
+		if (current.any) {
+			return true;
+		}
+
+		if (current.tokens.size() > rte.size()) {
+			continue;
+		}
+
+		size_t j = 0;
+		while (j < current.tokens.size() && (current.tokens[j] == rte[j] || current.tokens[j] == RouteTokenAny)) {
+			j++;
+		}
+
+		if (j == current.tokens.size()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//Checks a flight plan against the rules at the given Europe/London minute of the week
+CheckResult checkFlightPlan(const FlightPlanSnapshot& flightPlan, const std::shared_ptr<const SidRuleset>& ruleset, int minuteOfWeek) {
+	CheckResult result;
+	result.rules = ruleset;
+	const SidRuleset& rules = *ruleset;
+
+	string origin = flightPlan.origin; boost::to_upper(origin);
+	string destination = flightPlan.destination; boost::to_upper(destination);
+	uint32_t destKey = packIcao(destination);
+	const AirportRules* airport = rules.find(origin);
+
+	// Airport defined
+	if (airport == nullptr) {
+		result.sid = SidStatus::AirportNotFound;
+		return result;
+	}
+
+	int RFL = flightPlan.finalAltitude;
+
+	// Upper Case Route Without "DCT" And Speed/Level Change Instances
+	static thread_local RouteTokenizer tokenizer;
+	RouteError routeError = tokenizer.tokenize(flightPlan.route);
+
+	if (routeError != RouteError::None) {
+		result.syntax = routeError;
+		return result;
+	}
+
+	RouteItems& route = tokenizer.items;
+
+	string sid;
+	string first_wp;
+	string sid_suffix;
+	splitSid(*airport, flightPlan.sidName, sid, first_wp, sid_suffix);
+
+	// Flightplan has SID
+	if (!sid.length()) {
+		result.sid = SidStatus::NoneSet;
+		return result;
+	}
+
+	// Did not find a valid SID
+	if (0 == sid_suffix.length() && "VCT" != first_wp) {
+		result.sid = SidStatus::NoneSet;
+		return result;
+	}
+
+	// Check First Waypoint Correct. Remove SID References & First Waypoint From Route.
+	bool success = false;
+	bool stop = false;
+
+	while (!stop && route.size() > 0) {
+		size_t wp_size = first_wp.size();
+		size_t entry_size = route[0].size();
+		if (route[0].substr(0, wp_size) == first_wp) {
+			//First Waypoint
+			if (wp_size == entry_size) {
+				success = true;
+				stop = true;
+			}
+			//3 or 5 Letter Waypoint SID - In Full
+			else if (entry_size > wp_size && isdigit(route[0][wp_size])) {
+				//SID Has Letter Suffix
+				for (size_t i = wp_size + 1; i < entry_size; i++) {
+					if (!isalpha(route[0][i])) {
+						stop = true;
+					}
+				}
+			}
+			else {
+				stop = true;
+			}
+
+			route.erase(route.begin());
+		}
+		//5 Letter Waypoint SID - Abbreviated to 6 Chars
+		else if (wp_size == 5 && entry_size >= wp_size && isdigit(route[0][wp_size - 1])) {
+			//SID Has Letter Suffix
+			for (size_t i = wp_size; i < entry_size; i++) {
+				if (!isalpha(route[0][i])) {
+					stop = true;
+				}
+			}
+
+			route.erase(route.begin());
+		}
+		else {
+			stop = true;
+		}
+	}
+
+	if (!success) {
+		result.sid = SidStatus::WrongFirstFix;
+		return result;
+	}
+
+	RouteTokenIds routeIds;
+	rules.routeTokenIds(route, routeIds);
+
+	WaypointIds pointIds;
+	rules.waypointIds(flightPlan.points, pointIds);
+
+	// Any SIDs defined
+	if (!airport->hasSids) {
+		result.sid = SidStatus::NoneDefined;
+		return result;
+	}
+	const SidRule* sid_ele = airport->findSid(first_wp);
+
+	// Needed SID defined
+	if (sid_ele != nullptr) {
+		result.sidIndex = sid_ele - &airport->sids[0];
+
+		const vector<SidConstraint>& conditions = sid_ele->constraints;
+		char engineType = flightPlan.engineType;
+		char aircraftType = flightPlan.aircraftType;
+
+		int round = 0;
+
+		ConstraintMask validity = sid_ele->all;
+		vector<string> results;
+		bool sidFails[3]{ 0 };
+		bool restFails[3]{ 0 }; // 0 = Suffix, 1 = Aircraft/Engines, 2 = Date/Time Restrictions
+
+		//SID-Level Restrictions Array
+		sidFails[0] = true;
+		bool sidwide = sid_ele->restrictions.empty() || restrictionsPermit(sid_ele->restrictions, sid_suffix, engineType, aircraftType, minuteOfWeek, sidFails);
+
+		//Constraints Array
+		while (round < 6) {
+			//Constraints without a check for this round pass it unevaluated
+			ConstraintMask new_validity = validity;
+			new_validity.intersect(sid_ele->alwaysPass[round]);
+
+			ConstraintMask pending = validity;
+			pending.remove(sid_ele->alwaysPass[round]);
+
+			for (size_t i = 0; i < conditions.size(); i++) {
+				if (pending.test(i)) {
+					bool res = true;
+
+					switch (round) {
+					case 0:
+					{
+						//Destinations
+						if (conditions[i].nodests.size() && conditions[i].nodestPrefixes.matches(destKey, destination)) {
+							res = false;
+						}
+
+						if (conditions[i].dests.size() && !conditions[i].destPrefixes.matches(destKey, destination)) {
+							res = false;
+						}
+
+						break;
+					}
+					case 1:
+					{
+						//Route
+						if (conditions[i].routePatterns.size() && !routeContains(routeIds, conditions[i].routePatterns)) {
+							res = false;
+						}
+
+						if (conditions[i].points.size() && !waypointsIntersect(conditions[i].pointIds, pointIds)) {
+							res = false;
+						}
+
+						if (res && conditions[i].noroutePatterns.size() && routeContains(routeIds, conditions[i].noroutePatterns)) {
+							res = false;
+						}
+
+						if (conditions[i].nopoints.size() && waypointsIntersect(conditions[i].nopointIds, pointIds)) {
+							res = false;
+						}
+
+						break;
+					}
+					case 2:
+					{
+						//Nav Perf
+						/* if (conditions[i].hasNav) {
+							if (string::npos == conditions[i].nav.find_first_of(flightPlan.capabilities)) {
+								res = false;
+							}
+						} */
+
+						break; //Check disabled until future release
+					}
+					case 3:
+					{
+						//Min Level
+						if (conditions[i].hasMin && conditions[i].min > 0 && (RFL / 100) < conditions[i].min) {
+							res = false;
+						}
+
+						//Max Level
+						if (conditions[i].hasMax && conditions[i].max > 0 && (RFL / 100) > conditions[i].max) {
+							res = false;
+						}
+
+						break;
+					}
+					case 4:
+					{
+						//Assume any level valid if no "EVEN" or "ODD" declaration
+
+						//Even/Odd Levels
+						if (conditions[i].dir == LevelDirection::Even) {
+							//Assume invalid until condition matched
+							res = false;
+
+							//Non-RVSM (Above FL410)
+							if ((RFL > 41000 && (RFL / 1000 - 41) % 4 == 2)) {
+								res = true;
+							}
+							//RVSM (FL290-410) or Below FL290
+							else if (RFL <= 41000 && (RFL / 1000) % 2 == 0) {
+								res = true;
+							}
+						}
+						else if (conditions[i].dir == LevelDirection::Odd) {
+							//Assume invalid until condition matched
+							res = false;
+
+							//Non-RVSM (Above FL410)
+							if ((RFL > 41000 && (RFL / 1000 - 41) % 4 == 0)) {
+								res = true;
+							}
+							//RVSM (FL290-410) or Below FL290
+							else if (RFL <= 41000 && (RFL / 1000) % 2 == 1) {
+								res = true;
+							}
+						}
+
+						break;
+					}
+					case 5:
+					{
+						restFails[0] = true;
+						// Restrictions Array - Only test if SID-wide failed or is overriden for this constraint.
+						if (!sidwide || conditions[i].override) {
+							res = restrictionsPermit(conditions[i].restrictions, sid_suffix, engineType, aircraftType, minuteOfWeek, restFails);
+						}
+
+						break;
+					}
+					}
+
+					if (res) {
+						new_validity.set(i);
+					}
+				}
+			}
+
+			if (new_validity.none()) {
+				break;
+			}
+			else {
+				validity = new_validity;
+				round++;
+			}
+		}
+
+		result.round = round;
+		result.survivors = validity;
+		result.sidwide = sidwide;
+		copy(sidFails, sidFails + 3, result.sidFails);
+		copy(restFails, restFails + 3, result.restFails);
+
+		if (sidwide || round == 6) {
+			switch (round) {
+			case 6:
+			{
+				result.restrictions = CheckStatus::Passed;
+				result.passed = true;
+			}
+			//Falls through
+			case 5:
+			{
+				result.suffix = CheckStatus::Passed;
+
+				if (round == 5) {
+					if (restFails[0]) {
+						result.suffix = CheckStatus::Failed;
+					}
+					else {
+						result.restrictions = CheckStatus::Failed;
+					}
+				}
+
+				result.direction = CheckStatus::Passed;
+			}
+			//Falls through
+			case 4:
+			{
+				if (round == 4) {
+					result.direction = CheckStatus::Failed;
+				}
+
+				result.level = CheckStatus::Passed;
+			}
+			//Falls through
+			case 3:
+			{
+				if (round == 3) {
+					result.level = CheckStatus::Failed;
+				}
+
+				result.nav = CheckStatus::Passed;
+			}
+			//Falls through
+			case 2:
+			{
+				if (round == 2) {
+					result.nav = CheckStatus::Failed;
+				}
+
+				result.route = CheckStatus::Passed;
+			}
+			//Falls through
+			case 1:
+			{
+				if (round == 1) {
+					result.route = CheckStatus::Failed;
+				}
+
+				result.destination = CheckStatus::Passed;
+			}
+			//Falls through
+			case 0:
+			{
+				if (round == 0) {
+					result.destination = CheckStatus::Failed;
+				}
+				break;
+			}
+			}
+		}
+		else {
+			result.sidLevel = true;
+
+			if (sidFails[0]) {
+				result.suffix = CheckStatus::Failed;
+			}
+			else {
+				result.suffix = CheckStatus::Passed;
+
+				//sidFails[1] or [2] must be false to get here
+				result.restrictions = CheckStatus::Failed;
+			}
+		}
+
+		return result;
+	}
+	else {
+		result.sid = SidStatus::NotFound;
+		return result;
+	}
+}
+
+//Compiles list of failed elements in flight plan as tag codes
+vector<const char*> checkFails(const CheckResult& result) {
+	vector<const char*> fail;
+
+	if (result.sid != SidStatus::Valid) {
+		fail.push_back("SID");
+	}
+	if (result.destination == CheckStatus::Failed) {
+		fail.push_back("DST");
+	}
+	if (result.route == CheckStatus::Failed) {
+		fail.push_back("RTE");
+	}
+	if (result.nav == CheckStatus::Failed) {
+		fail.push_back("NAV");
+	}
+	if (result.level == CheckStatus::Failed) {
+		fail.push_back("MIN");
+		fail.push_back("MAX");
+	}
+	if (result.direction == CheckStatus::Failed) {
+		fail.push_back("DIR");
+	}
+	if (result.suffix == CheckStatus::Failed) {
+		fail.push_back("SUF");
+	}
+	if (result.restrictions == CheckStatus::Failed) {
+		fail.push_back("RST");
+	}
+	if (result.syntax != RouteError::None) {
+		fail.push_back("CHK");
+	}
+
+	return fail;
+}
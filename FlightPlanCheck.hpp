@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include "Ruleset.hpp"
+#include "FlightPlanSnapshot.hpp"
+#include "CheckResult.hpp"
+
+using namespace std;
+
+//Flight plan checks, independent of EuroScope. The plugin fills a FlightPlanSnapshot from CFlightPlan (CVFPCPlugin::getSnapshot), other callers from any recorded source.
+
+//Splits a SID name into its cleaned name, first waypoint and suffix
+void splitSid(const AirportRules& airport, const string& sidName, string& sid, string& first_wp, string& sid_suffix);
+
+//Checks a flight plan against the rules at the given Europe/London minute of the week (londonMinuteOfWeek)
+CheckResult checkFlightPlan(const FlightPlanSnapshot& flightPlan, const std::shared_ptr<const SidRuleset>& ruleset, int minuteOfWeek);
+
+//Tag codes of the checks a flight plan failed (SID, DST, RTE, ...), in display order
+vector<const char*> checkFails(const CheckResult& result);
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//Copy of the flight plan fields read by validizeSid, safe to use away from the EuroScope thread
+struct FlightPlanSnapshot {
+	string callsign;
+	string origin;
+	string destination;
+	string route;
+	int finalAltitude = 0;
+	string sidName;
+	char aircraftType = 0;
+	char engineType = 0;
+	char capabilities = 0;
+	string planType;
+	vector<string> points;	//Extracted route point names
+};
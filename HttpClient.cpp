@@ -0,0 +1,185 @@
+#include "HttpClient.hpp"
+#include <boost/algorithm/string.hpp>
+
+//Stores output of HTTP request in string
+static size_t curlCallback(void *contents, size_t size, size_t nmemb, void *outString)
+{
+	((string*)outString)->append(reinterpret_cast<char*>(contents), size * nmemb);
+	return size * nmemb;
+}
+
+//Stores ETag/Last-Modified/Content-Encoding response headers
+static size_t curlHeaderCallback(char *buffer, size_t size, size_t nitems, void *request)
+{
+	string header(buffer, size * nitems);
+	size_t colon = header.find(':');
+
+	if (colon != string::npos) {
+		string name = header.substr(0, colon);
+		string value = boost::trim_copy(header.substr(colon + 1));
+
+		if (boost::iequals(name, "ETag")) {
+			((HttpRequest*)request)->received.etag = value;
+		}
+		else if (boost::iequals(name, "Last-Modified")) {
+			((HttpRequest*)request)->received.lastModified = value;
+		}
+		else if (boost::iequals(name, "Content-Encoding")) {
+			((HttpRequest*)request)->encoding = value;
+		}
+	}
+
+	return size * nitems;
+}
+
+//Microseconds to milliseconds
+static double getMillis(CURL* handle, CURLINFO info) {
+	curl_off_t us = 0;
+	curl_easy_getinfo(handle, info, &us);
+	return us / 1000.0;
+}
+
+HttpClient::HttpClient() {
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+
+	share = curl_share_init();
+	curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+	curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+	curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+	multi = curl_multi_init();
+	handles.push_back(curl_easy_init());
+}
+
+HttpClient::~HttpClient() {
+	for (CURL* handle : handles) {
+		curl_easy_cleanup(handle);
+	}
+	curl_multi_cleanup(multi);
+	curl_share_cleanup(share);
+	curl_global_cleanup();
+}
+
+bool HttpClient::decodesCompression() {
+	return (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_LIBZ) != 0;
+}
+
+void HttpClient::lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* client) {
+	((HttpClient*)client)->shareMutexes[data].lock();
+}
+
+void HttpClient::unlockShare(CURL* handle, curl_lock_data data, void* client) {
+	((HttpClient*)client)->shareMutexes[data].unlock();
+}
+
+//Prepares a handle for a request, returns the header list to free once it has completed
+curl_slist* HttpClient::setup(CURL* handle, HttpRequest& request) {
+	struct curl_slist* headerList = nullptr;
+	for (const string& header : request.headers) {
+		headerList = curl_slist_append(headerList, header.c_str());
+	}
+
+	//Reset clears the options of the last request, but keeps open connections and caches
+	curl_easy_reset(handle);
+	curl_easy_setopt(handle, CURLOPT_SHARE, share);
+	curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_TIMEOUT, 10L);
+	curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, &request.body);
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, curlCallback);
+	curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, curlHeaderCallback);
+	curl_easy_setopt(handle, CURLOPT_HEADERDATA, &request);
+	//Empty string = every encoding the linked libcurl can decode. Has no effect if it was built without zlib (see decodesCompression).
+	curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headerList);
+
+	return headerList;
+}
+
+//Reads status and timing of a completed request and hands it to its callback
+void HttpClient::finish(CURL* handle, HttpRequest& request, CURLcode result, curl_slist* headerList) {
+	long connects = 0;
+
+	if (result == CURLE_OK) {
+		curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &request.status);
+	}
+	curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+
+	curl_off_t transferred = 0;
+	curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &transferred);
+	request.transferred = (size_t)transferred;
+
+	request.timing.nameLookup = getMillis(handle, CURLINFO_NAMELOOKUP_TIME_T);
+	request.timing.connect = getMillis(handle, CURLINFO_CONNECT_TIME_T);
+	request.timing.tls = getMillis(handle, CURLINFO_APPCONNECT_TIME_T);
+	request.timing.firstByte = getMillis(handle, CURLINFO_STARTTRANSFER_TIME_T);
+	request.timing.total = getMillis(handle, CURLINFO_TOTAL_TIME_T);
+	request.timing.reused = result == CURLE_OK && connects == 0;
+
+	//The list must outlive the transfer, and the handle must not point to it afterwards
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+	curl_slist_free_all(headerList);
+
+	if (request.done) {
+		request.done(request);
+	}
+}
+
+void HttpClient::get(HttpRequest& request) {
+	lock_guard<mutex> lock(requestMutex);
+
+	curl_slist* headerList = setup(handles[0], request);
+	finish(handles[0], request, curl_easy_perform(handles[0]), headerList);
+}
+
+void HttpClient::getAll(vector<HttpRequest>& requests) {
+	lock_guard<mutex> lock(requestMutex);
+
+	while (handles.size() < requests.size()) {
+		handles.push_back(curl_easy_init());
+	}
+
+	vector<curl_slist*> headerLists(requests.size());
+	vector<bool> pending(requests.size(), true);
+	for (size_t i = 0; i < requests.size(); i++) {
+		headerLists[i] = setup(handles[i], requests[i]);
+		curl_easy_setopt(handles[i], CURLOPT_PRIVATE, (void*)i);
+		curl_multi_add_handle(multi, handles[i]);
+	}
+
+	int running = (int)requests.size();
+	while (running > 0) {
+		if (curl_multi_perform(multi, &running) != CURLM_OK) {
+			break;
+		}
+
+		//Handle every request that completed as soon as it is done
+		CURLMsg* msg;
+		int queued;
+		while ((msg = curl_multi_info_read(multi, &queued)) != nullptr) {
+			if (msg->msg == CURLMSG_DONE) {
+				void* i;
+				curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &i);
+				curl_multi_remove_handle(multi, msg->easy_handle);
+				finish(handles[(size_t)i], requests[(size_t)i], msg->data.result, headerLists[(size_t)i]);
+				pending[(size_t)i] = false;
+			}
+		}
+
+		if (running > 0) {
+			curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+		}
+	}
+
+	//Only left if the multi handle itself failed
+	for (size_t i = 0; i < requests.size(); i++) {
+		if (pending[i]) {
+			curl_multi_remove_handle(multi, handles[i]);
+			finish(handles[i], requests[i], CURLE_FAILED_INIT, headerLists[i]);
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <curl/curl.h>
+
+using namespace std;
+
+//Validators of the last successful download, sent back as If-None-Match/If-Modified-Since
+struct HttpValidators {
+	string etag;
+	string lastModified;
+	bool notModified = false;	//Last request was answered with 304 Not Modified
+};
+
+//Phases of a request in milliseconds from its start, as reported by curl_easy_getinfo
+struct HttpTiming {
+	double nameLookup = 0;
+	double connect = 0;
+	double tls = 0;			//0 for plain HTTP and reused connections
+	double firstByte = 0;
+	double total = 0;
+	bool reused = false;	//No new connection had to be opened
+};
+
+//GET request and, once completed, its response
+struct HttpRequest {
+	string url;
+	vector<string> headers;				//Extra request headers, e.g. "If-None-Match: ..."
+	function<void(HttpRequest&)> done;	//Called as soon as the response is complete, on the fetching thread
+
+	long status = 0;			//HTTP status, 0 if the transfer failed
+	string body;				//Decoded if the response was compressed
+	size_t transferred = 0;		//Body bytes as received, before decoding
+	string encoding;			//Content-Encoding of the response, empty if uncompressed
+	HttpValidators received;	//ETag/Last-Modified response headers
+	HttpTiming timing;
+};
+
+//Long-lived HTTP client. Connections, DNS results and TLS sessions are kept between requests.
+//Compressed responses are requested and decoded if the linked libcurl supports it (decodesCompression).
+class HttpClient {
+public:
+	HttpClient();
+	~HttpClient();
+
+	HttpClient(const HttpClient&) = delete;
+	HttpClient& operator=(const HttpClient&) = delete;
+
+	//Performs a single request
+	void get(HttpRequest& request);
+
+	//Performs all requests in parallel, returning once every one has completed or timed out
+	void getAll(vector<HttpRequest>& requests);
+
+	//Whether the linked libcurl was built with zlib. If not, no Accept-Encoding is sent and every response arrives uncompressed.
+	//The bundled Libs/libcurl_a.lib is built without it, so the plugin DLL downloads uncompressed until it is rebuilt with zlib.
+	static bool decodesCompression();
+
+private:
+	CURLSH* share;
+	CURLM* multi;
+	vector<CURL*> handles;	//Reused between requests, grown to the largest batch
+	mutex requestMutex;
+	mutex shareMutexes[CURL_LOCK_DATA_LAST];
+
+	static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* client);
+	static void unlockShare(CURL* handle, curl_lock_data data, void* client);
+
+	curl_slist* setup(CURL* handle, HttpRequest& request);
+	void finish(CURL* handle, HttpRequest& request, CURLcode result, curl_slist* headerList);
+};
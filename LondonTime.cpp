@@ -0,0 +1,53 @@
+#include "LondonTime.hpp"
+
+const int64_t SecondsPerDay = 24 * 60 * 60;
+
+//Rounds towards negative infinity, so times before 1970 fall on the right day
+static int64_t floorDiv(int64_t a, int64_t b) {
+	return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+//Days since 1970-01-01 of a date in the proleptic Gregorian calendar
+static int64_t daysFromCivil(int64_t year, int month, int day) {
+	year -= month <= 2;
+	int64_t era = floorDiv(year, 400);
+	int64_t yearOfEra = year - era * 400;
+	int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+//Year of a day since 1970-01-01
+static int64_t yearFromDays(int64_t days) {
+	days += 719468;
+	int64_t era = floorDiv(days, 146097);
+	int64_t dayOfEra = days - era * 146097;
+	int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int64_t month = (5 * dayOfYear + 2) / 153;
+	return yearOfEra + era * 400 + (month >= 10);
+}
+
+//Day of the week of a day since 1970-01-01, 0 = Sunday (1970-01-01 was a Thursday)
+static int weekday(int64_t days) {
+	return (int)(days - floorDiv(days + 4, 7) * 7 + 4);
+}
+
+//01:00 UTC on the last Sunday of a month
+static UnixTime lastSundayChange(int64_t year, int month) {
+	int64_t last = daysFromCivil(year, month + 1, 1) - 1;
+	return (last - weekday(last)) * SecondsPerDay + 60 * 60;
+}
+
+bool britishSummerTime(UnixTime utc) {
+	int64_t year = yearFromDays(floorDiv(utc, SecondsPerDay));
+	return utc >= lastSundayChange(year, 3) && utc < lastSundayChange(year, 10);
+}
+
+int londonMinuteOfWeek(UnixTime utc) {
+	UnixTime local = utc + (britishSummerTime(utc) ? 60 * 60 : 0);
+	int64_t days = floorDiv(local, SecondsPerDay);
+	int64_t secondOfDay = local - days * SecondsPerDay;
+
+	return weekday(days) * 24 * 60 + (int)(secondOfDay / 60);
+}
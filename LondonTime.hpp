@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+
+//Unix time (seconds since 1970-01-01 00:00 UTC)
+typedef int64_t UnixTime;
+
+//Checks whether British Summer Time is in effect: from 01:00 UTC on the last Sunday of March to 01:00 UTC on the last Sunday of October
+bool britishSummerTime(UnixTime utc);
+
+//Europe/London local time as minutes from Sunday 0000, the format of CVFPCPlugin::getTimeKey
+int londonMinuteOfWeek(UnixTime utc);
@@ -0,0 +1,163 @@
+#include "RouteParser.hpp"
+
+//Reads exactly n digits at s[pos], advancing pos
+static bool readDigits(const char* s, size_t len, size_t& pos, size_t n, int& out) {
+	if (len - pos < n) {
+		return false;
+	}
+
+	int val = 0;
+	for (size_t i = 0; i < n; i++) {
+		char c = s[pos + i];
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		val = val * 10 + (c - '0');
+	}
+
+	pos += n;
+	out = val;
+	return true;
+}
+
+//Reads a level (F/A + 3 digits, S/M + 4 digits) at s[pos], advancing pos
+static bool readLevel(const char* s, size_t len, size_t& pos, char& unit, int& level) {
+	if (pos >= len) {
+		return false;
+	}
+
+	char c = s[pos];
+	size_t digits;
+	if (c == 'F' || c == 'A') {
+		digits = 3;
+	}
+	else if (c == 'S' || c == 'M') {
+		digits = 4;
+	}
+	else {
+		return false;
+	}
+
+	size_t at = pos + 1;
+	if (!readDigits(s, len, at, digits, level)) {
+		return false;
+	}
+
+	unit = c;
+	pos = at;
+	return true;
+}
+
+bool parseSpeedLevel(const char* s, size_t len, SpeedLevel& out, bool cruiseClimb) {
+	SpeedLevel group;
+	size_t pos = 1;
+
+	// Speed: N/M/K followed by 3 or 4 digits (3 accepted for knots and km/h as well, as filed by many pilots)
+	if (len < 1 || (s[0] != 'N' && s[0] != 'M' && s[0] != 'K')) {
+		return false;
+	}
+	group.speedUnit = s[0];
+
+	// A level letter can never be a digit, so a fourth digit always belongs to the speed
+	if (len > 4 && s[4] >= '0' && s[4] <= '9') {
+		if (!readDigits(s, len, pos, 4, group.speed)) {
+			return false;
+		}
+	}
+	else if (!readDigits(s, len, pos, 3, group.speed)) {
+		return false;
+	}
+
+	if (!readLevel(s, len, pos, group.levelUnit, group.level)) {
+		return false;
+	}
+
+	if (pos < len && cruiseClimb) {
+		if (len - pos == 4 && s[pos] == 'P' && s[pos + 1] == 'L' && s[pos + 2] == 'U' && s[pos + 3] == 'S') {
+			group.plus = true;
+			pos = len;
+		}
+		else if (!readLevel(s, len, pos, group.upperUnit, group.upperLevel)) {
+			return false;
+		}
+	}
+
+	if (pos != len) {
+		return false;
+	}
+
+	out = group;
+	return true;
+}
+
+RouteError RouteTokenizer::tokenize(const string& route) {
+	buffer.assign(route);
+	items.clear();
+	invalid = RouteItem();
+
+	bool leading = true;
+	size_t i = 0;
+
+	while (i < buffer.size()) {
+		if (buffer[i] == ' ') {
+			i++;
+			continue;
+		}
+
+		// Upper case the item in place while looking for "/"
+		size_t start = i;
+		size_t first_pos = 0;
+		size_t pos = 0;
+		int count = 0;
+
+		for (; i < buffer.size() && buffer[i] != ' '; i++) {
+			char& c = buffer[i];
+			if (c >= 'a' && c <= 'z') {
+				c = c - 'a' + 'A';
+			}
+			else if (c == '/') {
+				if (count == 0) {
+					first_pos = i - start;
+				}
+				pos = i - start;
+				count++;
+			}
+		}
+
+		RouteItem item(buffer.data() + start, i - start);
+		SpeedLevel change;
+
+		// 1 = POINT/N0450F350, 2 = Cruise Climb C/POINT/N0450F350F390 or C/POINT/N0450F350PLUS
+		if (count == 1 || count == 2) {
+			bool cruiseClimb = count == 2;
+
+			if ((cruiseClimb && (first_pos != 1 || item[0] != 'C')) || !parseSpeedLevel(item.data() + pos + 1, item.size() - pos - 1, change, cruiseClimb)) {
+				invalid = item;
+				return RouteError::SpeedLevel;
+			}
+
+			item = cruiseClimb ? item.substr(first_pos + 1, pos - first_pos - 1) : item.substr(0, pos);
+		}
+		else if (count > 2) {
+			invalid = item;
+			return RouteError::Syntax;
+		}
+
+		if (item == "DCT") {
+			continue;
+		}
+
+		// Speed/Level Data at the start of the route
+		if (leading) {
+			leading = false;
+
+			if (parseSpeedLevel(item.data(), item.size(), change)) {
+				continue;
+			}
+		}
+
+		items.push_back(item);
+	}
+
+	return RouteError::None;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <boost/utility/string_view.hpp>
+#include <boost/container/small_vector.hpp>
+
+using namespace std;
+
+//ICAO speed/level group, e.g. N0450F350, or as a cruise climb N0450F350F390 / N0450F350PLUS
+struct SpeedLevel {
+	char speedUnit = 0;		//N = Knots, M = Mach, K = km/h
+	int speed = 0;
+	char levelUnit = 0;		//F = Flight Level, A = Altitude (100s ft), S = Metric Level (10s m), M = Metric Altitude (10s m)
+	int level = 0;
+
+	char upperUnit = 0;		//Cruise climb upper level, 0 if none
+	int upperLevel = 0;
+	bool plus = false;		//Cruise climb "PLUS" (no upper level given)
+};
+
+//Parses a complete speed/level group without allocating. Cruise climb upper levels are only accepted if cruiseClimb is set.
+bool parseSpeedLevel(const char* s, size_t len, SpeedLevel& out, bool cruiseClimb = false);
+
+//Route item, pointing into the buffer of the RouteTokenizer that produced it
+typedef boost::string_view RouteItem;
+typedef boost::container::small_vector<RouteItem, 64> RouteItems;
+
+enum class RouteError {
+	None,
+	SpeedLevel,	//Item with one or two "/" whose speed/level group is invalid
+	Syntax		//Item with more than two "/"
+};
+
+//Splits a filed route into upper case items in a single pass, removing "DCT", speed/level changes
+//and a leading speed/level group. Items stay valid until the next call; buffers are kept between calls.
+struct RouteTokenizer {
+	RouteItems items;
+	RouteItem invalid;	//Offending item if tokenize failed
+
+	RouteError tokenize(const string& route);
+
+private:
+	string buffer;
+};
@@ -0,0 +1,1228 @@
+#include "Ruleset.hpp"
+#include <sstream>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include <set>
+#include <boost/algorithm/string.hpp>
+
+//Reads the string entries of an array member, if present
+static vector<string> stringArray(const Value& obj, const char* name) {
+	vector<string> out{};
+
+	if (obj.IsObject() && obj.HasMember(name) && obj[name].IsArray()) {
+		const Value& a = obj[name];
+		for (SizeType i = 0; i < a.Size(); i++) {
+			if (a[i].IsString()) {
+				out.push_back(a[i].GetString());
+			}
+		}
+	}
+
+	return out;
+}
+
+uint32_t packIcao(const string& icao) {
+	return packIcao(icao.c_str(), icao.size());
+}
+
+uint32_t packIcao(const char* icao, size_t len) {
+	uint32_t out = 0;
+
+	for (size_t i = 0; i < 4; i++) {
+		out <<= 8;
+		if (i < len) {
+			out |= (unsigned char)icao[i];
+		}
+	}
+
+	return out;
+}
+
+//Fibonacci hash of a packed ICAO, keeping the top bits for the table size
+static size_t icaoSlot(uint32_t key, unsigned int shift) {
+	return shift >= 32 ? 0 : (uint32_t)(key * 2654435769u) >> shift;
+}
+
+static DestinationPrefixes compilePrefixes(const vector<string>& entries) {
+	DestinationPrefixes out;
+
+	for (const string& each : entries) {
+		//An empty entry matches nothing and ends the list
+		if (each.empty()) {
+			break;
+		}
+
+		if (each.size() > 4) {
+			out.longer.push_back(each);
+		}
+		else {
+			out.packed.push_back(packIcao(each));
+			out.lengths |= 1 << (each.size() - 1);
+		}
+	}
+
+	sort(out.packed.begin(), out.packed.end());
+	out.packed.erase(unique(out.packed.begin(), out.packed.end()), out.packed.end());
+
+	return out;
+}
+
+bool DestinationPrefixes::matches(uint32_t dest, const string& s) const {
+	static const uint32_t masks[4] = { 0xFF000000, 0xFFFF0000, 0xFFFFFF00, 0xFFFFFFFF };
+
+	//A destination shorter than the prefix has zero bytes where the prefix has characters, so never matches
+	for (size_t n = 0; n < 4; n++) {
+		if ((lengths >> n & 1) && binary_search(packed.begin(), packed.end(), dest & masks[n])) {
+			return true;
+		}
+	}
+
+	for (const string& each : longer) {
+		if (s.compare(0, each.size(), each) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//Interns waypoint names into a sorted ID set
+static vector<unsigned int> compileWaypoints(const vector<string>& names, SidRuleset& ruleset) {
+	vector<unsigned int> out{};
+
+	for (const string& each : names) {
+		unsigned int id = (unsigned int)ruleset.waypoints.size();
+		out.push_back(ruleset.waypoints.insert(pair<string, unsigned int>(each, id)).first->second);
+	}
+
+	sort(out.begin(), out.end());
+	out.erase(unique(out.begin(), out.end()), out.end());
+
+	return out;
+}
+
+bool waypointsIntersect(const vector<unsigned int>& a, const WaypointIds& b) {
+	size_t i = 0;
+	size_t j = 0;
+
+	while (i < a.size() && j < b.size()) {
+		if (a[i] == b[j]) {
+			return true;
+		}
+		else if (a[i] < b[j]) {
+			i++;
+		}
+		else {
+			j++;
+		}
+	}
+
+	return false;
+}
+
+//Splits a route pattern on spaces, converts each token to upper case and interns it
+static RoutePattern compilePattern(const string& s, SidRuleset& ruleset) {
+	RoutePattern out;
+	istringstream iss(s);
+	string item;
+
+	while (getline(iss, item, ' ')) {
+		boost::to_upper(item);
+
+		if (item == "*") {
+			out.tokens.push_back(RouteTokenAny);
+		}
+		else {
+			// IDs start at 1, after RouteTokenAny
+			unsigned int id = (unsigned int)ruleset.routeTokens.size() + 1;
+			out.tokens.push_back(ruleset.routeTokens.insert(pair<string, unsigned int>(item, id)).first->second);
+		}
+	}
+
+	out.any = out.tokens.size() == 1 && out.tokens[0] == RouteTokenAny;
+	if (out.tokens.size() > ruleset.longestRoutePattern) {
+		ruleset.longestRoutePattern = out.tokens.size();
+	}
+
+	return out;
+}
+
+//Parses "HHMM" into hours and minutes
+static bool parseTime(const string& s, int out[2]) {
+	if (s.size() < 4 || !isdigit(s[0]) || !isdigit(s[1]) || !isdigit(s[2]) || !isdigit(s[3])) {
+		return false;
+	}
+
+	out[0] = (s[0] - '0') * 10 + (s[1] - '0');
+	out[1] = (s[2] - '0') * 10 + (s[3] - '0');
+	return true;
+}
+
+static bool parseTime(const Value& v, int out[2]) {
+	return v.IsString() && parseTime(string(v.GetString()), out);
+}
+
+//Checks whether a day/time (timedata: 0 = Day, 1 = Hour, 2 = Minute) lies within a restriction's window
+static bool windowOpen(const SidRestriction& rest, const vector<int>& timedata) {
+	const int* starttime = rest.startTime;
+	const int* endtime = rest.endTime;
+	int startdate = rest.startDate;
+	int enddate = rest.endDate;
+
+	if (!rest.date && rest.time) {
+		if (starttime[0] > endtime[0] || (starttime[0] == endtime[0] && starttime[1] >= endtime[1])) {
+			if (timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1]) || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1])) {
+				return true;
+			}
+		}
+		else {
+			if ((timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) && (timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1]))) {
+				return true;
+			}
+		}
+	}
+	else if (startdate == enddate) {
+		if (!rest.time) {
+			return true;
+		}
+		else if ((timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) && (timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1]))) {
+			return true;
+		}
+	}
+	else if (startdate < enddate) {
+		if (timedata[0] > startdate && timedata[0] < enddate) {
+			return true;
+		}
+		else if (timedata[0] == startdate) {
+			if (!rest.time || timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) {
+				return true;
+			}
+		}
+		else if (timedata[0] == enddate) {
+			if (!rest.time || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] < endtime[1])) {
+				return true;
+			}
+		}
+	}
+	else if (startdate > enddate) {
+		if (timedata[0] < startdate || timedata[0] > enddate) {
+			return true;
+		}
+		else if (timedata[0] == startdate) {
+			if (!rest.time || timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) {
+				return true;
+			}
+		}
+		else if (timedata[0] == enddate) {
+			if (!rest.time || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] < endtime[1])) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+//Evaluates a restriction's window for every minute of the week
+static void compileWindow(SidRestriction& rest) {
+	std::shared_ptr<bitset<MinutesPerWeek>> window = std::make_shared<bitset<MinutesPerWeek>>();
+	vector<int> timedata = { 0, 0, 0 };
+
+	for (int minute = 0; minute < MinutesPerWeek; minute++) {
+		timedata[0] = minute / (24 * 60);
+		timedata[1] = minute / 60 % 24;
+		timedata[2] = minute % 60;
+
+		(*window)[minute] = windowOpen(rest, timedata);
+	}
+
+	rest.window = window;
+}
+
+//Derives the lookup fields of a restriction from its entries
+static void finishRestriction(SidRestriction& rest) {
+	for (const string& each : rest.types) {
+		rest.typeCodes += each.size() ? each[0] : '\0';
+	}
+
+	if (rest.date || rest.time) {
+		compileWindow(rest);
+	}
+}
+
+static vector<SidRestriction> compileRestrictions(const Value& obj) {
+	vector<SidRestriction> out{};
+
+	if (!obj.HasMember("restrictions") || !obj["restrictions"].IsArray()) {
+		return out;
+	}
+
+	const Value& rests = obj["restrictions"];
+	for (SizeType i = 0; i < rests.Size(); i++) {
+		const Value& r = rests[i];
+		SidRestriction rest;
+
+		if (!r.IsObject()) {
+			out.push_back(rest);
+			continue;
+		}
+
+		rest.types = stringArray(r, "types");
+		rest.suffix = stringArray(r, "suffix");
+		rest.alt = stringArray(r, "alt");
+
+		if (r.HasMember("start") && r["start"].IsObject() && r.HasMember("end") && r["end"].IsObject()) {
+			const Value& start = r["start"];
+			const Value& end = r["end"];
+
+			if (start.HasMember("date") && start["date"].IsInt() && end.HasMember("date") && end["date"].IsInt()) {
+				rest.date = true;
+				rest.startDate = start["date"].GetInt();
+				rest.endDate = end["date"].GetInt();
+			}
+
+			if (start.HasMember("time") && end.HasMember("time") && parseTime(start["time"], rest.startTime) && parseTime(end["time"], rest.endTime)) {
+				rest.time = true;
+			}
+		}
+
+		finishRestriction(rest);
+		out.push_back(rest);
+	}
+
+	return out;
+}
+
+//Reads a "dir" value
+static LevelDirection parseDirection(string direction) {
+	boost::to_upper(direction);
+
+	if (direction == "EVEN") {
+		return LevelDirection::Even;
+	}
+	else if (direction == "ODD") {
+		return LevelDirection::Odd;
+	}
+	else {
+		return LevelDirection::Other;
+	}
+}
+
+//Compiles the destination, route and waypoint entries of a constraint, interning their names into ruleset
+static void finishConstraint(SidConstraint& con, SidRuleset& ruleset) {
+	con.destPrefixes = compilePrefixes(con.dests);
+	con.nodestPrefixes = compilePrefixes(con.nodests);
+	for (const string& each : con.route) {
+		con.routePatterns.push_back(compilePattern(each, ruleset));
+	}
+	for (const string& each : con.noroute) {
+		con.noroutePatterns.push_back(compilePattern(each, ruleset));
+	}
+
+	con.pointIds = compileWaypoints(con.points, ruleset);
+	con.nopointIds = compileWaypoints(con.nopoints, ruleset);
+}
+
+static SidConstraint compileConstraint(const Value& c, SidRuleset& ruleset) {
+	SidConstraint con;
+
+	if (!c.IsObject()) {
+		return con;
+	}
+
+	con.dests = stringArray(c, "dests");
+	con.nodests = stringArray(c, "nodests");
+	con.route = stringArray(c, "route");
+	con.noroute = stringArray(c, "noroute");
+	con.points = stringArray(c, "points");
+	con.nopoints = stringArray(c, "nopoints");
+
+	if (c.HasMember("nav") && c["nav"].IsString()) {
+		con.hasNav = true;
+		con.nav = c["nav"].GetString();
+	}
+
+	if (c.HasMember("min") && c["min"].IsInt()) {
+		con.hasMin = true;
+		con.min = c["min"].GetInt();
+	}
+
+	if (c.HasMember("max") && c["max"].IsInt()) {
+		con.hasMax = true;
+		con.max = c["max"].GetInt();
+	}
+
+	if (c.HasMember("dir") && c["dir"].IsString()) {
+		con.dir = parseDirection(c["dir"].GetString());
+	}
+
+	con.override = c.HasMember("override") && c["override"].IsBool() && c["override"].GetBool();
+	con.restrictions = compileRestrictions(c);
+
+	finishConstraint(con, ruleset);
+	return con;
+}
+
+//Sorts a SID's compiled constraints into the masks the elimination rounds start from
+static void compileMasks(SidRule& sid) {
+	size_t count = sid.constraints.size();
+	sid.all = ConstraintMask(count);
+	for (size_t round = 0; round < ConstraintRounds; round++) {
+		sid.alwaysPass[round] = ConstraintMask(count);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const SidConstraint& con = sid.constraints[i];
+		sid.all.set(i);
+
+		if (con.dests.empty() && con.nodests.empty()) {
+			sid.alwaysPass[0].set(i);
+		}
+
+		if (con.routePatterns.empty() && con.points.empty() && con.noroutePatterns.empty() && con.nopoints.empty()) {
+			sid.alwaysPass[1].set(i);
+		}
+
+		//Nav Performance check disabled until future release
+		sid.alwaysPass[2].set(i);
+
+		if (!(con.hasMin && con.min > 0) && !(con.hasMax && con.max > 0)) {
+			sid.alwaysPass[3].set(i);
+		}
+
+		if (con.dir != LevelDirection::Even && con.dir != LevelDirection::Odd) {
+			sid.alwaysPass[4].set(i);
+		}
+
+		//Restrictions are always evaluated, as they also report suffix/type/time failures
+	}
+}
+
+static SidRule compileSid(const Value& s, SidRuleset& ruleset) {
+	SidRule sid;
+	sid.point = s["point"].GetString();
+	sid.restrictions = compileRestrictions(s);
+
+	if (s.HasMember("constraints") && s["constraints"].IsArray()) {
+		sid.hasConstraints = true;
+
+		const Value& conditions = s["constraints"];
+		for (SizeType i = 0; i < conditions.Size(); i++) {
+			sid.constraints.push_back(compileConstraint(conditions[i], ruleset));
+		}
+	}
+
+	compileMasks(sid);
+	return sid;
+}
+
+//SID names that don't start with their first waypoint: Airport, SID Name, First Waypoint
+static const char* const knownSidAliases[][3] = {
+	{ "EGLL", "CHK", "CPT" }
+};
+
+static void clearRuleset(SidRuleset& out) {
+	out.airports.clear();
+	out.slots.clear();
+	out.slotShift = 32;
+	out.otherAirports.clear();
+	out.routeTokens.clear();
+	out.longestRoutePattern = 0;
+	out.waypoints.clear();
+}
+
+//Indexes an airport's compiled SIDs and adds it to out. Returns false if an airport with the same ICAO was added before.
+static bool addAirport(AirportRules& rules, SidRuleset& out, set<string>& icaos) {
+	//Later entries for the same point replace earlier ones
+	for (size_t j = 0; j < rules.sids.size(); j++) {
+		if (rules.sids[j].hasConstraints) {
+			rules.sidIndex[rules.sids[j].point] = j;
+		}
+	}
+
+	for (const auto& alias : knownSidAliases) {
+		if (rules.icao == alias[0]) {
+			rules.sidAliases[alias[1]] = alias[2];
+		}
+	}
+
+	//First entry wins if an airport is listed twice
+	if (!icaos.insert(rules.icao).second) {
+		return false;
+	}
+
+	out.airports.push_back(move(rules));
+	return true;
+}
+
+//Compiles parsed API/Sid.json data into typed rules
+void compileRuleset(const Value& config, SidRuleset& out) {
+	clearRuleset(out);
+
+	if (!config.IsArray()) {
+		return;
+	}
+
+	set<string> icaos;
+
+	for (SizeType i = 0; i < config.Size(); i++) {
+		const Value& airport = config[i];
+		if (!airport.IsObject() || !airport.HasMember("icao") || !airport["icao"].IsString()) {
+			continue;
+		}
+
+		AirportRules rules;
+		rules.icao = airport["icao"].GetString();
+
+		if (airport.HasMember("sids") && airport["sids"].IsArray()) {
+			rules.hasSids = true;
+
+			const Value& sids = airport["sids"];
+			for (SizeType j = 0; j < sids.Size(); j++) {
+				if (sids[j].IsObject() && sids[j].HasMember("point") && sids[j]["point"].IsString()) {
+					rules.sids.push_back(compileSid(sids[j], out));
+				}
+			}
+		}
+
+		addAirport(rules, out, icaos);
+	}
+
+	out.buildIndex();
+}
+
+//Members compileRulesetStream reads
+enum class RulesetKey {
+	None,		//Not part of the schema, skipped
+	Repeated,	//Member listed again in the same object, skipped as compileRuleset only reads the first
+	Icao, Sids,
+	Point, Constraints, Restrictions,
+	Dests, Nodests, Route, Noroute, Points, Nopoints, Nav, Min, Max, Dir, Override,
+	Types, Suffix, Alt, Start, End,
+	Date, Time
+};
+
+//Objects and arrays of the schema, as they are nested in the stream
+enum class RulesetFrame {
+	Airports, Airport,
+	Sids, Sid,
+	Constraints, Constraint,
+	Restrictions, Restriction,
+	Bound,		//"start"/"end" of a restriction
+	Strings		//String array member
+};
+
+static const struct {
+	RulesetFrame object;
+	RulesetKey key;
+	const char* name;
+	const char* expected;
+} rulesetMembers[] = {
+	{ RulesetFrame::Airport, RulesetKey::Icao, "icao", "a string" },
+	{ RulesetFrame::Airport, RulesetKey::Sids, "sids", "an array" },
+	{ RulesetFrame::Sid, RulesetKey::Point, "point", "a string" },
+	{ RulesetFrame::Sid, RulesetKey::Constraints, "constraints", "an array" },
+	{ RulesetFrame::Sid, RulesetKey::Restrictions, "restrictions", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Dests, "dests", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Nodests, "nodests", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Route, "route", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Noroute, "noroute", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Points, "points", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Nopoints, "nopoints", "an array" },
+	{ RulesetFrame::Constraint, RulesetKey::Nav, "nav", "a string" },
+	{ RulesetFrame::Constraint, RulesetKey::Min, "min", "an integer" },
+	{ RulesetFrame::Constraint, RulesetKey::Max, "max", "an integer" },
+	{ RulesetFrame::Constraint, RulesetKey::Dir, "dir", "a string" },
+	{ RulesetFrame::Constraint, RulesetKey::Override, "override", "true or false" },
+	{ RulesetFrame::Constraint, RulesetKey::Restrictions, "restrictions", "an array" },
+	{ RulesetFrame::Restriction, RulesetKey::Types, "types", "an array" },
+	{ RulesetFrame::Restriction, RulesetKey::Suffix, "suffix", "an array" },
+	{ RulesetFrame::Restriction, RulesetKey::Alt, "alt", "an array" },
+	{ RulesetFrame::Restriction, RulesetKey::Start, "start", "an object" },
+	{ RulesetFrame::Restriction, RulesetKey::End, "end", "an object" },
+	{ RulesetFrame::Bound, RulesetKey::Date, "date", "an integer" },
+	{ RulesetFrame::Bound, RulesetKey::Time, "time", "an \"HHMM\" string" }
+};
+
+//SAX handler of compileRulesetStream. Fills the same structures compileRuleset reads from a DOM, skipping and reporting what doesn't fit the schema.
+//Airports are only compiled once complete, as "icao" may follow "sids" and compileRuleset never compiles the SIDs of an airport without one.
+class RulesetStreamHandler {
+public:
+	RulesetStreamHandler(InsituStringStream& stream, SidRuleset& out, vector<RulesetIssue>& issues) : stream(stream), out(out), issues(issues) {
+		frames.reserve(8);
+	}
+
+	void Null() {
+		scalar(Scalar::Null);
+	}
+
+	void Bool(bool b) {
+		Scalar v(Scalar::Bool);
+		v.b = b;
+		scalar(v);
+	}
+
+	void Int(int i) {
+		Scalar v(Scalar::Int);
+		v.i = i;
+		scalar(v);
+	}
+
+	//Only non-negative numbers are passed as unsigned, IsInt() accepts those that fit an int
+	void Uint(unsigned u) {
+		if (u <= INT_MAX) {
+			Int((int)u);
+		}
+		else {
+			scalar(Scalar::Number);
+		}
+	}
+
+	//Only passed numbers outside the range of int/unsigned
+	void Int64(int64_t /*i*/) {
+		scalar(Scalar::Number);
+	}
+
+	void Uint64(uint64_t /*u*/) {
+		scalar(Scalar::Number);
+	}
+
+	void Double(double /*d*/) {
+		scalar(Scalar::Number);
+	}
+
+	//Member names arrive as strings too. Null-terminated in-situ, and like GetString() read up to the first null.
+	void String(const char* s, SizeType length, bool /*copy*/) {
+		if (skipDepth == 0 && frames.size() && isObject(frames.back().type) && !frames.back().member) {
+			memberName(s, length);
+			return;
+		}
+
+		Scalar v(Scalar::String);
+		v.s = s;
+		scalar(v);
+	}
+
+	void StartObject() {
+		if (skipDepth) {
+			skipDepth++;
+			return;
+		}
+
+		if (frames.empty()) {
+			issue("data is not an array, no rules compiled");
+			skipDepth = 1;
+			return;
+		}
+
+		Frame& f = frames.back();
+		switch (f.type) {
+		case RulesetFrame::Airports:
+			airport = AirportRules();
+			hasIcao = false;
+			push(RulesetFrame::Airport);
+			break;
+		case RulesetFrame::Sids:
+			airport.sids.push_back(SidRule());
+			hasPoint = false;
+			push(RulesetFrame::Sid);
+			break;
+		case RulesetFrame::Constraints:
+			airport.sids.back().constraints.push_back(SidConstraint());
+			push(RulesetFrame::Constraint);
+			break;
+		case RulesetFrame::Restrictions:
+			f.restrictions->push_back(SidRestriction());
+			bounds[0] = Bound();
+			bounds[1] = Bound();
+			push(RulesetFrame::Restriction, f.restrictions);
+			break;
+		case RulesetFrame::Strings:
+			issue(string("non-string entry in \"") + name(f.key) + "\" skipped");
+			skipDepth = 1;
+			break;
+		default:
+			if (f.type == RulesetFrame::Restriction && (f.key == RulesetKey::Start || f.key == RulesetKey::End)) {
+				int bound = f.key == RulesetKey::Start ? 0 : 1;
+				bounds[bound].present = true;
+				push(RulesetFrame::Bound, nullptr, bound);
+			}
+			else {
+				wrongType(f.key);
+				skipDepth = 1;
+			}
+		}
+	}
+
+	void EndObject(SizeType /*count*/) {
+		end();
+	}
+
+	void StartArray() {
+		if (skipDepth) {
+			skipDepth++;
+			return;
+		}
+
+		if (frames.empty()) {
+			push(RulesetFrame::Airports);
+			return;
+		}
+
+		Frame& f = frames.back();
+		switch (f.type) {
+		case RulesetFrame::Airports:
+		case RulesetFrame::Sids:
+		case RulesetFrame::Constraints:
+		case RulesetFrame::Restrictions:
+		case RulesetFrame::Strings:
+			element(f);
+			skipDepth = 1;
+			return;
+		default:
+			break;
+		}
+
+		switch (f.key) {
+		case RulesetKey::Sids:
+			airport.hasSids = true;
+			push(RulesetFrame::Sids);
+			break;
+		case RulesetKey::Constraints:
+			airport.sids.back().hasConstraints = true;
+			push(RulesetFrame::Constraints);
+			break;
+		case RulesetKey::Restrictions:
+			push(RulesetFrame::Restrictions, f.type == RulesetFrame::Sid ? &airport.sids.back().restrictions : &constraint().restrictions);
+			break;
+		case RulesetKey::Dests:
+			pushStrings(f.key, constraint().dests);
+			break;
+		case RulesetKey::Nodests:
+			pushStrings(f.key, constraint().nodests);
+			break;
+		case RulesetKey::Route:
+			pushStrings(f.key, constraint().route);
+			break;
+		case RulesetKey::Noroute:
+			pushStrings(f.key, constraint().noroute);
+			break;
+		case RulesetKey::Points:
+			pushStrings(f.key, constraint().points);
+			break;
+		case RulesetKey::Nopoints:
+			pushStrings(f.key, constraint().nopoints);
+			break;
+		case RulesetKey::Types:
+			pushStrings(f.key, f.restrictions->back().types);
+			break;
+		case RulesetKey::Suffix:
+			pushStrings(f.key, f.restrictions->back().suffix);
+			break;
+		case RulesetKey::Alt:
+			pushStrings(f.key, f.restrictions->back().alt);
+			break;
+		default:
+			wrongType(f.key);
+			skipDepth = 1;
+		}
+	}
+
+	void EndArray(SizeType /*count*/) {
+		end();
+	}
+
+private:
+	struct Scalar {
+		enum Kind { Null, Bool, Int, Number, String } kind;
+		bool b = false;
+		int i = 0;
+		const char* s = nullptr;
+
+		Scalar(Kind kind) : kind(kind) {}
+	};
+
+	//"start"/"end" object of the restriction being read
+	struct Bound {
+		bool present = false;	//First "start"/"end" member is an object
+		bool hasDate = false;
+		int date = 0;
+		bool hasTime = false;	//Has a "time" member of any type
+		bool timeValid = false;
+		int time[2] = { 0, 0 };
+	};
+
+	struct Frame {
+		RulesetFrame type;
+		RulesetKey key;		//Member whose value is expected, or of a Strings array
+		bool member;		//Member name read, value expected
+		uint32_t seen;		//Bit per RulesetKey already read
+		vector<string>* strings;
+		vector<SidRestriction>* restrictions;
+		int bound;
+	};
+
+	InsituStringStream& stream;
+	SidRuleset& out;
+	vector<RulesetIssue>& issues;
+
+	vector<Frame> frames;
+	int skipDepth = 0;		//Nesting depth within a value being skipped
+
+	AirportRules airport;	//Airport being read
+	bool hasIcao = false;
+	bool hasPoint = false;	//Of the SID being read
+	Bound bounds[2];		//Of the restriction being read
+	set<string> icaos;
+
+	static bool isObject(RulesetFrame type) {
+		return type == RulesetFrame::Airport || type == RulesetFrame::Sid || type == RulesetFrame::Constraint || type == RulesetFrame::Restriction || type == RulesetFrame::Bound;
+	}
+
+	static const char* name(RulesetKey key) {
+		for (const auto& each : rulesetMembers) {
+			if (each.key == key) {
+				return each.name;
+			}
+		}
+		return "";
+	}
+
+	void issue(const string& message) {
+		RulesetIssue each;
+		each.offset = stream.Tell();
+		each.message = message;
+		issues.push_back(each);
+	}
+
+	void wrongType(RulesetKey key) {
+		for (const auto& each : rulesetMembers) {
+			if (each.key == key) {
+				issue(string("\"") + each.name + "\" is not " + each.expected + ", ignored");
+				return;
+			}
+		}
+	}
+
+	SidConstraint& constraint() {
+		return airport.sids.back().constraints.back();
+	}
+
+	void push(RulesetFrame type, vector<SidRestriction>* restrictions = nullptr, int bound = 0) {
+		Frame f;
+		f.type = type;
+		f.key = RulesetKey::None;
+		f.member = false;
+		f.seen = 0;
+		f.strings = nullptr;
+		f.restrictions = restrictions;
+		f.bound = bound;
+		frames.push_back(f);
+	}
+
+	void pushStrings(RulesetKey key, vector<string>& strings) {
+		push(RulesetFrame::Strings);
+		frames.back().key = key;
+		frames.back().strings = &strings;
+	}
+
+	void memberName(const char* s, SizeType length) {
+		Frame& f = frames.back();
+		f.key = RulesetKey::None;
+		f.member = true;
+
+		for (const auto& each : rulesetMembers) {
+			if (each.object == f.type && strlen(each.name) == length && memcmp(each.name, s, length) == 0) {
+				f.key = each.key;
+				break;
+			}
+		}
+
+		if (f.key == RulesetKey::None) {
+			return;
+		}
+
+		uint32_t bit = 1u << (int)f.key;
+		if (f.seen & bit) {
+			issue(string("\"") + name(f.key) + "\" listed again, ignored");
+			f.key = RulesetKey::Repeated;
+			return;
+		}
+		f.seen |= bit;
+
+		if (f.key == RulesetKey::Time) {
+			bounds[f.bound].hasTime = true;
+		}
+	}
+
+	//Entry of an array that isn't an object (or string, for Strings)
+	void element(Frame& f) {
+		switch (f.type) {
+		case RulesetFrame::Airports:
+			issue("airport is not an object, skipped");
+			break;
+		case RulesetFrame::Sids:
+			issue("SID is not an object, skipped");
+			break;
+		case RulesetFrame::Constraints:
+			airport.sids.back().constraints.push_back(SidConstraint());
+			issue("constraint is not an object, compiled without conditions");
+			break;
+		case RulesetFrame::Restrictions:
+			f.restrictions->push_back(SidRestriction());
+			issue("restriction is not an object, compiled without conditions");
+			break;
+		default:
+			issue(string("non-string entry in \"") + name(f.key) + "\" skipped");
+		}
+	}
+
+	void scalar(const Scalar& v) {
+		if (skipDepth || frames.empty()) {
+			return;
+		}
+
+		Frame& f = frames.back();
+		if (f.type == RulesetFrame::Strings && v.kind == Scalar::String) {
+			f.strings->push_back(v.s);
+		}
+		else if (!isObject(f.type)) {
+			element(f);
+		}
+		else {
+			member(f, v);
+			valueDone();
+		}
+	}
+
+	void member(Frame& f, const Scalar& v) {
+		Bound& bound = bounds[f.bound];
+
+		switch (f.key) {
+		case RulesetKey::None:
+		case RulesetKey::Repeated:
+			return;
+		case RulesetKey::Icao:
+			if (v.kind == Scalar::String) {
+				airport.icao = v.s;
+				hasIcao = true;
+				return;
+			}
+			break;
+		case RulesetKey::Point:
+			if (v.kind == Scalar::String) {
+				airport.sids.back().point = v.s;
+				hasPoint = true;
+				return;
+			}
+			break;
+		case RulesetKey::Nav:
+			if (v.kind == Scalar::String) {
+				constraint().hasNav = true;
+				constraint().nav = v.s;
+				return;
+			}
+			break;
+		case RulesetKey::Min:
+			if (v.kind == Scalar::Int) {
+				constraint().hasMin = true;
+				constraint().min = v.i;
+				return;
+			}
+			break;
+		case RulesetKey::Max:
+			if (v.kind == Scalar::Int) {
+				constraint().hasMax = true;
+				constraint().max = v.i;
+				return;
+			}
+			break;
+		case RulesetKey::Dir:
+			if (v.kind == Scalar::String) {
+				constraint().dir = parseDirection(v.s);
+				return;
+			}
+			break;
+		case RulesetKey::Override:
+			if (v.kind == Scalar::Bool) {
+				constraint().override = v.b;
+				return;
+			}
+			break;
+		case RulesetKey::Date:
+			if (v.kind == Scalar::Int) {
+				bound.hasDate = true;
+				bound.date = v.i;
+				return;
+			}
+			break;
+		case RulesetKey::Time:
+			if (v.kind == Scalar::String && parseTime(string(v.s), bound.time)) {
+				bound.timeValid = true;
+				return;
+			}
+			break;
+		default:
+			break;
+		}
+
+		wrongType(f.key);
+	}
+
+	//A member's value has been read, the next string is a member name
+	void valueDone() {
+		if (frames.size() && isObject(frames.back().type)) {
+			frames.back().key = RulesetKey::None;
+			frames.back().member = false;
+		}
+	}
+
+	void end() {
+		if (skipDepth) {
+			if (--skipDepth == 0) {
+				valueDone();
+			}
+			return;
+		}
+
+		Frame f = frames.back();
+		frames.pop_back();
+
+		switch (f.type) {
+		case RulesetFrame::Airport:
+			endAirport();
+			break;
+		case RulesetFrame::Sid:
+			if (!hasPoint) {
+				airport.sids.pop_back();
+				issue("SID without a \"point\" string skipped");
+			}
+			break;
+		case RulesetFrame::Restriction:
+			endRestriction(f.restrictions->back());
+			break;
+		default:
+			break;
+		}
+
+		valueDone();
+	}
+
+	void endAirport() {
+		if (!hasIcao) {
+			issue("airport without an \"icao\" string skipped");
+			return;
+		}
+
+		for (SidRule& sid : airport.sids) {
+			for (SidConstraint& con : sid.constraints) {
+				finishConstraint(con, out);
+			}
+			compileMasks(sid);
+		}
+
+		if (!addAirport(airport, out, icaos)) {
+			issue("airport " + airport.icao + " listed again, skipped");
+		}
+	}
+
+	//Both "start" and "end" are needed for a window, as in compileRestrictions
+	void endRestriction(SidRestriction& rest) {
+		const Bound& start = bounds[0];
+		const Bound& end = bounds[1];
+
+		if (start.present && end.present) {
+			if (start.hasDate && end.hasDate) {
+				rest.date = true;
+				rest.startDate = start.date;
+				rest.endDate = end.date;
+			}
+
+			//compileRestrictions parses the start time first, so it is kept even if the end time is invalid
+			if (start.hasTime && end.hasTime && start.timeValid) {
+				rest.startTime[0] = start.time[0];
+				rest.startTime[1] = start.time[1];
+
+				if (end.timeValid) {
+					rest.endTime[0] = end.time[0];
+					rest.endTime[1] = end.time[1];
+					rest.time = true;
+				}
+			}
+		}
+
+		finishRestriction(rest);
+	}
+};
+
+//Compiles API/Sid.json text into typed rules in a single pass, without building a DOM
+bool compileRulesetStream(char* text, SidRuleset& out, vector<RulesetIssue>& issues) {
+	clearRuleset(out);
+
+	InsituStringStream stream(text);
+	RulesetStreamHandler handler(stream, out, issues);
+	Reader reader;
+
+	if (!reader.Parse<kParseInsituFlag>(stream, handler)) {
+		RulesetIssue error;
+		error.offset = reader.GetErrorOffset();
+		error.message = reader.GetParseError();
+		issues.push_back(error);
+		return false;
+	}
+
+	out.buildIndex();
+	return true;
+}
+
+const SidRule* AirportRules::findSid(const string& point) const {
+	unordered_map<string, size_t>::const_iterator it = sidIndex.find(point);
+	if (it == sidIndex.end()) {
+		return nullptr;
+	}
+
+	return &sids[it->second];
+}
+
+void SidRuleset::buildIndex() {
+	//At most half full, so probe sequences stay short
+	size_t size = 8;
+	slotShift = 29;
+	while (size < airports.size() * 2) {
+		size *= 2;
+		slotShift--;
+	}
+
+	slots.assign(size, AirportSlot());
+	otherAirports.clear();
+
+	for (size_t i = 0; i < airports.size(); i++) {
+		const string& icao = airports[i].icao;
+
+		if (icao.empty() || icao.size() > 4 || icao.find('\0') != string::npos) {
+			otherAirports.insert(pair<string, size_t>(icao, i));
+			continue;
+		}
+
+		uint32_t key = packIcao(icao);
+		size_t slot = icaoSlot(key, slotShift);
+		while (slots[slot].key != 0) {
+			slot = (slot + 1) & (size - 1);
+		}
+
+		slots[slot].key = key;
+		slots[slot].airport = (uint32_t)i;
+	}
+}
+
+const AirportRules* SidRuleset::find(const string& icao) const {
+	if (icao.size() > 4 || icao.find('\0') != string::npos) {
+		map<string, size_t>::const_iterator it = otherAirports.find(icao);
+		return it == otherAirports.end() ? nullptr : &airports[it->second];
+	}
+
+	return find(icao.c_str());
+}
+
+const AirportRules* SidRuleset::find(const char* icao) const {
+	size_t len = 0;
+	while (len < 5 && icao[len] != '\0') {
+		len++;
+	}
+
+	if (len == 0 || len > 4) {
+		map<string, size_t>::const_iterator it = otherAirports.find(icao);
+		return it == otherAirports.end() ? nullptr : &airports[it->second];
+	}
+
+	if (slots.empty()) {
+		return nullptr;
+	}
+
+	uint32_t key = packIcao(icao, len);
+	size_t mask = slots.size() - 1;
+	for (size_t slot = icaoSlot(key, slotShift); slots[slot].key != 0; slot = (slot + 1) & mask) {
+		if (slots[slot].key == key) {
+			return &airports[slots[slot].airport];
+		}
+	}
+
+	return nullptr;
+}
+
+void SidRuleset::routeTokenIds(const RouteItems& route, RouteTokenIds& out) const {
+	out.clear();
+
+	for (size_t i = 0; i < route.size() && i < longestRoutePattern; i++) {
+		map<string, unsigned int, less<>>::const_iterator it = routeTokens.find(route[i]);
+		out.push_back(it == routeTokens.end() ? RouteTokenUnknown : it->second);
+	}
+}
+
+void SidRuleset::waypointIds(const vector<string>& points, WaypointIds& out) const {
+	out.clear();
+
+	for (const string& each : points) {
+		map<string, unsigned int, less<>>::const_iterator it = waypoints.find(each);
+		if (it != waypoints.end()) {
+			out.push_back(it->second);
+		}
+	}
+
+	sort(out.begin(), out.end());
+	out.erase(unique(out.begin(), out.end()), out.end());
+}
+
+//Checks whether a suffix ends with any of the given endings
+static bool endsWithAny(const vector<string>& endings, const string& s) {
+	for (const string& comp : endings) {
+		if (comp.size() <= s.size() && s.compare(s.size() - comp.size(), comp.size(), comp) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//Checks a restrictions array against a flight. Returns true if any restriction permits it.
+bool restrictionsPermit(const vector<SidRestriction>& rests, const string& sid_suffix, char engineType, char aircraftType, int minuteOfWeek, bool fails[3]) {
+	bool permitted = false;
+
+	for (const SidRestriction& rest : rests) {
+		bool temp = true;
+
+		if (rest.typeCodes.size()) {
+			fails[1] = true;
+			if (rest.typeCodes.find(engineType) == string::npos && rest.typeCodes.find(aircraftType) == string::npos) {
+				temp = false;
+			}
+		}
+
+		if (rest.suffix.size()) {
+			if (endsWithAny(rest.suffix, sid_suffix)) {
+				fails[0] = false;
+			}
+			else {
+				temp = false;
+			}
+		}
+		else {
+			fails[0] = false;
+		}
+
+		if (rest.date || rest.time) {
+			fails[2] = true;
+
+			if (minuteOfWeek < 0 || minuteOfWeek >= MinutesPerWeek || (rest.window && !(*rest.window)[minuteOfWeek])) {
+				temp = false;
+			}
+		}
+
+		if (temp) {
+			permitted = true;
+		}
+	}
+
+	return permitted;
+}
@@ -0,0 +1,220 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <bitset>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include "rapidjson/document.h"
+#include "RouteParser.hpp"
+
+using namespace std;
+using namespace rapidjson;
+
+//Odd/Even cruise level requirement of a constraint
+enum class LevelDirection {
+	Any,	//No "dir" declared
+	Even,
+	Odd,
+	Other	//"dir" declared, but neither EVEN nor ODD
+};
+
+//Route token ID reserved for "*"
+const unsigned int RouteTokenAny = 0;
+//Route token ID of a route item that appears in no pattern
+const unsigned int RouteTokenUnknown = 0xFFFFFFFF;
+
+//"route"/"noroute" entry as interned token IDs
+struct RoutePattern {
+	vector<unsigned int> tokens;	//RouteTokenAny where the pattern has "*"
+	bool any = false;				//Pattern is a single "*" and accepts every route
+};
+
+//Route items of a flight plan as interned token IDs, only as many as the longest pattern needs
+typedef boost::container::small_vector<unsigned int, 16> RouteTokenIds;
+
+//Packs the first 4 characters of an ICAO code into an integer, first character in the high byte
+uint32_t packIcao(const string& icao);
+uint32_t packIcao(const char* icao, size_t len);
+
+//"dests"/"nodests" entries compiled for prefix matching against a destination
+struct DestinationPrefixes {
+	vector<uint32_t> packed;	//Sorted packed prefixes of up to 4 characters
+	unsigned int lengths = 0;	//Bit n - 1 set if a prefix of n characters exists
+	vector<string> longer;		//Prefixes of more than 4 characters
+
+	//dest = packIcao(s)
+	bool matches(uint32_t dest, const string& s) const;
+};
+
+//Interned waypoint IDs of a flight plan, sorted and without duplicates
+typedef boost::container::small_vector<unsigned int, 32> WaypointIds;
+
+//Checks whether a sorted constraint ID set and a flight plan's waypoint IDs share a waypoint
+bool waypointsIntersect(const vector<unsigned int>& a, const WaypointIds& b);
+
+//Minutes from Sunday 0000 to the end of Saturday, the range of CVFPCPlugin::getTimeKey
+const int MinutesPerWeek = 7 * 24 * 60;
+
+//Compiled "restrictions" entry (SID-wide or per-constraint)
+struct SidRestriction {
+	string typeCodes;		//First character of each "types" entry, matched against engine/aircraft type
+	vector<string> types;	//"types" entries as written, for output
+	vector<string> suffix;
+	vector<string> alt;
+
+	bool date = false;
+	bool time = false;
+	int startDate = 0;
+	int endDate = 0;
+	int startTime[2] = { 0, 0 };	//0 = Hours, 1 = Minutes
+	int endTime[2] = { 0, 0 };
+	std::shared_ptr<const bitset<MinutesPerWeek>> window;	//Minutes of the week the date/time window is open. Only allocated if date or time is set, always open if null.
+};
+
+//Compiled "constraints" entry
+struct SidConstraint {
+	vector<string> dests;
+	vector<string> nodests;
+	DestinationPrefixes destPrefixes;
+	DestinationPrefixes nodestPrefixes;
+	vector<string> route;
+	vector<string> noroute;
+	vector<RoutePattern> routePatterns;
+	vector<RoutePattern> noroutePatterns;
+	vector<string> points;
+	vector<string> nopoints;
+	vector<unsigned int> pointIds;		//Sorted interned "points"
+	vector<unsigned int> nopointIds;	//Sorted interned "nopoints"
+
+	bool hasNav = false;
+	string nav;
+
+	bool hasMin = false;
+	bool hasMax = false;
+	int min = 0;
+	int max = 0;
+
+	LevelDirection dir = LevelDirection::Any;
+	bool override = false;
+
+	vector<SidRestriction> restrictions;
+};
+
+//Number of constraint elimination rounds: 0 = Destination, 1 = Route, 2 = Nav Performance, 3 = Min/Max Level, 4 = Level Direction, 5 = Restrictions
+const size_t ConstraintRounds = 6;
+
+//Set of constraint indices of a SID, one bit per constraint
+struct ConstraintMask {
+	boost::container::small_vector<uint64_t, 1> words;
+
+	ConstraintMask(size_t count = 0) : words((count + 63) / 64, 0) {}
+
+	void set(size_t i) {
+		words[i / 64] |= uint64_t(1) << (i % 64);
+	}
+
+	bool test(size_t i) const {
+		return (words[i / 64] >> (i % 64) & 1) != 0;
+	}
+
+	bool none() const {
+		for (uint64_t w : words) {
+			if (w) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Keeps only constraints also in other
+	void intersect(const ConstraintMask& other) {
+		for (size_t i = 0; i < words.size(); i++) {
+			words[i] &= other.words[i];
+		}
+	}
+
+	//Removes constraints in other
+	void remove(const ConstraintMask& other) {
+		for (size_t i = 0; i < words.size(); i++) {
+			words[i] &= ~other.words[i];
+		}
+	}
+};
+
+//Compiled "sids" entry
+struct SidRule {
+	string point;
+	bool hasConstraints = false;	//Only SIDs with a "constraints" array can be assigned
+	vector<SidRestriction> restrictions;
+	vector<SidConstraint> constraints;
+
+	ConstraintMask all;								//Every constraint
+	ConstraintMask alwaysPass[ConstraintRounds];	//Constraints that pass a round without being evaluated
+};
+
+//Compiled airport entry
+struct AirportRules {
+	string icao;
+	bool hasSids = false;
+	vector<SidRule> sids;
+
+	unordered_map<string, size_t> sidIndex;	//SID point -> last SID with constraints for it
+	map<string, string> sidAliases;			//SID names that don't start with their first waypoint -> first waypoint
+
+	//Finds the SID that applies to a first waypoint, nullptr if none
+	const SidRule* findSid(const string& point) const;
+};
+
+//Complete set of compiled rules, built once per data load
+struct SidRuleset {
+	unsigned int generation = 0;	//Data load that built these rules, 0 = none yet
+
+	//Open addressing slot of the airport table, key 0 = empty
+	struct AirportSlot {
+		uint32_t key = 0;	//packIcao of the airport's ICAO
+		uint32_t airport = 0;
+	};
+
+	vector<AirportRules> airports;
+	vector<AirportSlot> slots;		//Airports with a 1 - 4 character ICAO, size is a power of two
+	unsigned int slotShift = 32;	//32 - log2(slots.size())
+	map<string, size_t> otherAirports;	//Airports with any other ICAO
+
+	map<string, unsigned int, less<>> routeTokens;	//Upper case route pattern token -> ID
+	size_t longestRoutePattern = 0;
+
+	map<string, unsigned int, less<>> waypoints;	//"points"/"nopoints" name -> ID
+
+	const AirportRules* find(const string& icao) const;
+	const AirportRules* find(const char* icao) const;
+
+	//Builds the airport table from airports
+	void buildIndex();
+
+	//Converts the start of a flight plan route into token IDs for RoutePattern matching
+	void routeTokenIds(const RouteItems& route, RouteTokenIds& out) const;
+
+	//Converts a flight plan's extracted route points into waypoint IDs. Points named in no constraint are left out.
+	void waypointIds(const vector<string>& points, WaypointIds& out) const;
+};
+
+//Compiles parsed API/Sid.json data into typed rules
+void compileRuleset(const Value& config, SidRuleset& out);
+
+//Problem found by compileRulesetStream, at a byte offset into the text
+struct RulesetIssue {
+	size_t offset;
+	string message;
+};
+
+//Compiles API/Sid.json text into typed rules in a single SAX pass, without building a DOM. text is parsed in-situ.
+//Produces the same rules as compileRuleset. Entries that don't fit the schema are skipped as there, and reported in issues.
+//Returns false on a JSON syntax error, which is reported last in issues. out is left partly filled then.
+bool compileRulesetStream(char* text, SidRuleset& out, vector<RulesetIssue>& issues);
+
+//Checks a restrictions array against a flight. Returns true if any restriction permits it.
+//fails[0] is cleared if any restriction accepts the suffix, fails[1]/fails[2] are set if type/time restrictions were checked.
+bool restrictionsPermit(const vector<SidRestriction>& rests, const string& sid_suffix, char engineType, char aircraftType, int minuteOfWeek, bool fails[3]);
@@ -0,0 +1,922 @@
+#include "RulesetSnapshot.hpp"
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//Snapshot layout. All integers are little-endian, every section starts at a multiple of 8 bytes.
+//A range is a run of consecutive elements in the section of its element type, a string is a run of bytes in the string section.
+
+struct SnapRange {
+	uint32_t first;
+	uint32_t count;
+};
+
+struct SnapString {
+	uint32_t offset;
+	uint32_t length;
+};
+
+enum SnapSection {
+	SnapStrings,		//Bytes, shared by every string
+	SnapNames,			//SnapString, string lists such as "dests"
+	SnapWords32,		//uint32_t, packed prefixes and interned IDs
+	SnapWords64,		//uint64_t, restriction windows and constraint masks
+	SnapAirports,
+	SnapSids,
+	SnapConstraints,
+	SnapRestrictions,
+	SnapPatterns,
+	SnapSidIndex,		//SnapEntry, SID point -> index within the airport's SIDs
+	SnapSidAliases,
+	SnapSlots,
+	SnapOtherAirports,	//SnapEntry, ICAO -> airport
+	SnapRouteTokens,	//SnapEntry, token -> ID
+	SnapWaypoints,		//SnapEntry, name -> ID
+	SnapSectionCount
+};
+
+struct SnapTable {
+	uint32_t offset;	//From the start of the file
+	uint32_t count;		//Elements, not bytes
+};
+
+struct SnapHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t fileSize;
+	uint32_t checksum;	//FNV-1a of everything after the header
+	int64_t fetched;
+	SnapString etag;
+	SnapString lastModified;
+	uint32_t slotShift;
+	uint32_t longestRoutePattern;
+	SnapTable sections[SnapSectionCount];
+};
+
+struct SnapPrefixes {
+	SnapRange packed;	//Words32
+	uint32_t lengths;
+	SnapRange longer;	//Names
+};
+
+struct SnapPattern {
+	SnapRange tokens;	//Words32
+	uint32_t any;
+};
+
+struct SnapRestriction {
+	SnapString typeCodes;
+	SnapRange types;	//Names
+	SnapRange suffix;	//Names
+	SnapRange alt;		//Names
+	uint32_t flags;		//SnapDate | SnapTime
+	int32_t startDate;
+	int32_t endDate;
+	int32_t startTime[2];
+	int32_t endTime[2];
+	SnapRange window;	//Words64, SnapWindowWords if date or time is set, otherwise empty
+};
+
+struct SnapConstraint {
+	SnapRange dests;			//Names
+	SnapRange nodests;			//Names
+	SnapPrefixes destPrefixes;
+	SnapPrefixes nodestPrefixes;
+	SnapRange route;			//Names
+	SnapRange noroute;			//Names
+	SnapRange routePatterns;	//Patterns
+	SnapRange noroutePatterns;	//Patterns
+	SnapRange points;			//Names
+	SnapRange nopoints;			//Names
+	SnapRange pointIds;			//Words32
+	SnapRange nopointIds;		//Words32
+	uint32_t flags;				//SnapHasNav | SnapHasMin | SnapHasMax | SnapOverride
+	SnapString nav;
+	int32_t min;
+	int32_t max;
+	uint32_t dir;				//LevelDirection
+	SnapRange restrictions;
+};
+
+struct SnapSid {
+	SnapString point;
+	uint32_t hasConstraints;
+	SnapRange restrictions;
+	SnapRange constraints;
+	SnapRange masks;	//Words64, "all" then alwaysPass of each round, (constraints + 63) / 64 words each
+};
+
+struct SnapAirport {
+	SnapString icao;
+	uint32_t hasSids;
+	SnapRange sids;
+	SnapRange sidIndex;
+	SnapRange sidAliases;
+};
+
+struct SnapEntry {
+	SnapString name;
+	uint32_t value;
+};
+
+struct SnapPair {
+	SnapString key;
+	SnapString value;
+};
+
+struct SnapSlot {
+	uint32_t key;
+	uint32_t airport;
+};
+
+static const char SnapMagic[8] = { 'V', 'F', 'P', 'C', 'R', 'U', 'L', 'E' };
+
+static const uint32_t SnapDate = 1;
+static const uint32_t SnapTime = 2;
+
+static const uint32_t SnapHasNav = 1;
+static const uint32_t SnapHasMin = 2;
+static const uint32_t SnapHasMax = 4;
+static const uint32_t SnapOverride = 8;
+
+static const uint32_t SnapWindowWords = (MinutesPerWeek + 63) / 64;
+
+//Element size of each section
+static const size_t snapElementSize[SnapSectionCount] = {
+	1, sizeof(SnapString), sizeof(uint32_t), sizeof(uint64_t),
+	sizeof(SnapAirport), sizeof(SnapSid), sizeof(SnapConstraint), sizeof(SnapRestriction), sizeof(SnapPattern),
+	sizeof(SnapEntry), sizeof(SnapPair), sizeof(SnapSlot), sizeof(SnapEntry), sizeof(SnapEntry), sizeof(SnapEntry)
+};
+
+static_assert(sizeof(SnapHeader) == 56 + SnapSectionCount * 8, "SnapHeader must not contain padding");
+static_assert(sizeof(SnapRestriction) == 68 && sizeof(SnapConstraint) == 152 && sizeof(SnapSid) == 36 && sizeof(SnapAirport) == 36, "Snapshot records must not contain padding");
+
+static uint32_t fnv1a(const char* data, size_t size) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+//Collects the sections of a snapshot while walking the compiled rules
+class SnapshotEncoder {
+public:
+	string strings;
+	vector<SnapString> names;
+	vector<uint32_t> words32;
+	vector<uint64_t> words64;
+	vector<SnapAirport> airports;
+	vector<SnapSid> sids;
+	vector<SnapConstraint> constraints;
+	vector<SnapRestriction> restrictions;
+	vector<SnapPattern> patterns;
+	vector<SnapEntry> sidIndex;
+	vector<SnapPair> sidAliases;
+	vector<SnapSlot> slots;
+	vector<SnapEntry> otherAirports;
+	vector<SnapEntry> routeTokens;
+	vector<SnapEntry> waypoints;
+
+	//Identical strings are stored once
+	SnapString str(const string& s) {
+		map<string, SnapString>::const_iterator it = interned.find(s);
+		if (it != interned.end()) {
+			return it->second;
+		}
+
+		SnapString out = { (uint32_t)strings.size(), (uint32_t)s.size() };
+		strings += s;
+		interned.insert(pair<string, SnapString>(s, out));
+		return out;
+	}
+
+	SnapRange nameList(const vector<string>& list) {
+		SnapRange out = { (uint32_t)names.size(), (uint32_t)list.size() };
+		for (const string& each : list) {
+			names.push_back(str(each));
+		}
+		return out;
+	}
+
+	template <class T>
+	SnapRange wordList(const T& list) {
+		SnapRange out = { (uint32_t)words32.size(), (uint32_t)list.size() };
+		words32.insert(words32.end(), list.begin(), list.end());
+		return out;
+	}
+
+	SnapRange window(const bitset<MinutesPerWeek>& bits) {
+		SnapRange out = { (uint32_t)words64.size(), SnapWindowWords };
+		for (uint32_t i = 0; i < SnapWindowWords; i++) {
+			words64.push_back(((bits >> (i * 64)) & bitset<MinutesPerWeek>(~0ULL)).to_ullong());
+		}
+		return out;
+	}
+
+	SnapRange masks(const SidRule& sid) {
+		SnapRange out = { (uint32_t)words64.size(), 0 };
+		words64.insert(words64.end(), sid.all.words.begin(), sid.all.words.end());
+		for (const ConstraintMask& each : sid.alwaysPass) {
+			words64.insert(words64.end(), each.words.begin(), each.words.end());
+		}
+		out.count = (uint32_t)(words64.size() - out.first);
+		return out;
+	}
+
+	SnapPrefixes prefixes(const DestinationPrefixes& prefixes) {
+		SnapPrefixes out;
+		out.packed = wordList(prefixes.packed);
+		out.lengths = prefixes.lengths;
+		out.longer = nameList(prefixes.longer);
+		return out;
+	}
+
+	SnapRange patternList(const vector<RoutePattern>& list) {
+		vector<SnapPattern> encoded;
+		for (const RoutePattern& each : list) {
+			SnapPattern p;
+			p.tokens = wordList(each.tokens);
+			p.any = each.any;
+			encoded.push_back(p);
+		}
+		return append(patterns, encoded);
+	}
+
+	SnapRange restrictionList(const vector<SidRestriction>& list) {
+		vector<SnapRestriction> encoded;
+		for (const SidRestriction& each : list) {
+			SnapRestriction r;
+			r.typeCodes = str(each.typeCodes);
+			r.types = nameList(each.types);
+			r.suffix = nameList(each.suffix);
+			r.alt = nameList(each.alt);
+			r.flags = (each.date ? SnapDate : 0) | (each.time ? SnapTime : 0);
+			r.startDate = each.startDate;
+			r.endDate = each.endDate;
+			r.startTime[0] = each.startTime[0];
+			r.startTime[1] = each.startTime[1];
+			r.endTime[0] = each.endTime[0];
+			r.endTime[1] = each.endTime[1];
+			//Windows are always stored if date or time is set, a missing one as always open
+			r.window = r.flags ? window(each.window ? *each.window : bitset<MinutesPerWeek>().set()) : SnapRange{ 0, 0 };
+			encoded.push_back(r);
+		}
+		return append(restrictions, encoded);
+	}
+
+	SnapRange constraintList(const vector<SidConstraint>& list) {
+		vector<SnapConstraint> encoded;
+		for (const SidConstraint& each : list) {
+			SnapConstraint c;
+			c.dests = nameList(each.dests);
+			c.nodests = nameList(each.nodests);
+			c.destPrefixes = prefixes(each.destPrefixes);
+			c.nodestPrefixes = prefixes(each.nodestPrefixes);
+			c.route = nameList(each.route);
+			c.noroute = nameList(each.noroute);
+			c.routePatterns = patternList(each.routePatterns);
+			c.noroutePatterns = patternList(each.noroutePatterns);
+			c.points = nameList(each.points);
+			c.nopoints = nameList(each.nopoints);
+			c.pointIds = wordList(each.pointIds);
+			c.nopointIds = wordList(each.nopointIds);
+			c.flags = (each.hasNav ? SnapHasNav : 0) | (each.hasMin ? SnapHasMin : 0) | (each.hasMax ? SnapHasMax : 0) | (each.override ? SnapOverride : 0);
+			c.nav = str(each.nav);
+			c.min = each.min;
+			c.max = each.max;
+			c.dir = (uint32_t)each.dir;
+			c.restrictions = restrictionList(each.restrictions);
+			encoded.push_back(c);
+		}
+		return append(constraints, encoded);
+	}
+
+	SnapRange sidList(const vector<SidRule>& list) {
+		vector<SnapSid> encoded;
+		for (const SidRule& each : list) {
+			SnapSid s;
+			s.point = str(each.point);
+			s.hasConstraints = each.hasConstraints;
+			s.restrictions = restrictionList(each.restrictions);
+			s.constraints = constraintList(each.constraints);
+			s.masks = masks(each);
+			encoded.push_back(s);
+		}
+		return append(sids, encoded);
+	}
+
+	template <class M>
+	void entries(const M& in, vector<SnapEntry>& out) {
+		for (const auto& each : in) {
+			SnapEntry e = { str(each.first), (uint32_t)each.second };
+			out.push_back(e);
+		}
+	}
+
+	void airport(const AirportRules& rules) {
+		SnapAirport a;
+		a.icao = str(rules.icao);
+		a.hasSids = rules.hasSids;
+		a.sids = sidList(rules.sids);
+
+		//Sorted, so the same rules always give the same file
+		map<string, size_t> index(rules.sidIndex.begin(), rules.sidIndex.end());
+		a.sidIndex = SnapRange{ (uint32_t)sidIndex.size(), (uint32_t)index.size() };
+		entries(index, sidIndex);
+
+		a.sidAliases = SnapRange{ (uint32_t)sidAliases.size(), (uint32_t)rules.sidAliases.size() };
+		for (const auto& each : rules.sidAliases) {
+			SnapPair p = { str(each.first), str(each.second) };
+			sidAliases.push_back(p);
+		}
+
+		airports.push_back(a);
+	}
+
+private:
+	map<string, SnapString> interned;
+
+	//Records of one list are appended together, as a range must be consecutive
+	template <class T>
+	static SnapRange append(vector<T>& section, const vector<T>& records) {
+		SnapRange out = { (uint32_t)section.size(), (uint32_t)records.size() };
+		section.insert(section.end(), records.begin(), records.end());
+		return out;
+	}
+};
+
+template <class T>
+static void writeSection(vector<char>& out, SnapHeader& header, SnapSection id, const T* data, size_t count) {
+	out.resize((out.size() + 7) & ~(size_t)7, 0);
+	header.sections[id].offset = (uint32_t)out.size();
+	header.sections[id].count = (uint32_t)count;
+
+	if (count) {
+		const char* bytes = reinterpret_cast<const char*>(data);
+		out.insert(out.end(), bytes, bytes + count * sizeof(T));
+	}
+}
+
+void encodeRulesetSnapshot(const SidRuleset& rules, const RulesetSnapshotInfo& info, vector<char>& out) {
+	SnapshotEncoder enc;
+
+	for (const AirportRules& each : rules.airports) {
+		enc.airport(each);
+	}
+	for (const SidRuleset::AirportSlot& each : rules.slots) {
+		SnapSlot s = { each.key, each.airport };
+		enc.slots.push_back(s);
+	}
+	enc.entries(rules.otherAirports, enc.otherAirports);
+	enc.entries(rules.routeTokens, enc.routeTokens);
+	enc.entries(rules.waypoints, enc.waypoints);
+
+	SnapHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SnapMagic, sizeof(SnapMagic));
+	header.version = RulesetSnapshotVersion;
+	header.headerSize = sizeof(SnapHeader);
+	header.fetched = info.fetched;
+	header.etag = enc.str(info.etag);
+	header.lastModified = enc.str(info.lastModified);
+	header.slotShift = rules.slotShift;
+	header.longestRoutePattern = (uint32_t)rules.longestRoutePattern;
+
+	out.assign(sizeof(SnapHeader), 0);
+	writeSection(out, header, SnapStrings, enc.strings.data(), enc.strings.size());
+	writeSection(out, header, SnapNames, enc.names.data(), enc.names.size());
+	writeSection(out, header, SnapWords32, enc.words32.data(), enc.words32.size());
+	writeSection(out, header, SnapWords64, enc.words64.data(), enc.words64.size());
+	writeSection(out, header, SnapAirports, enc.airports.data(), enc.airports.size());
+	writeSection(out, header, SnapSids, enc.sids.data(), enc.sids.size());
+	writeSection(out, header, SnapConstraints, enc.constraints.data(), enc.constraints.size());
+	writeSection(out, header, SnapRestrictions, enc.restrictions.data(), enc.restrictions.size());
+	writeSection(out, header, SnapPatterns, enc.patterns.data(), enc.patterns.size());
+	writeSection(out, header, SnapSidIndex, enc.sidIndex.data(), enc.sidIndex.size());
+	writeSection(out, header, SnapSidAliases, enc.sidAliases.data(), enc.sidAliases.size());
+	writeSection(out, header, SnapSlots, enc.slots.data(), enc.slots.size());
+	writeSection(out, header, SnapOtherAirports, enc.otherAirports.data(), enc.otherAirports.size());
+	writeSection(out, header, SnapRouteTokens, enc.routeTokens.data(), enc.routeTokens.size());
+	writeSection(out, header, SnapWaypoints, enc.waypoints.data(), enc.waypoints.size());
+
+	header.fileSize = (uint32_t)out.size();
+	header.checksum = fnv1a(out.data() + sizeof(SnapHeader), out.size() - sizeof(SnapHeader));
+	memcpy(out.data(), &header, sizeof(header));
+}
+
+bool writeRulesetSnapshot(const string& path, const SidRuleset& rules, const RulesetSnapshotInfo& info, string& error) {
+	vector<char> data;
+	encodeRulesetSnapshot(rules, info, data);
+
+	string temp = path + ".tmp";
+	ofstream ofs(temp.c_str(), ios::binary | ios::trunc);
+	if (!ofs.is_open()) {
+		error = "could not create " + temp;
+		return false;
+	}
+
+	ofs.write(data.data(), data.size());
+	ofs.close();
+	if (!ofs) {
+		error = "could not write " + temp;
+		return false;
+	}
+
+#ifdef _WIN32
+	if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+	if (rename(temp.c_str(), path.c_str()) != 0) {
+#endif
+		error = "could not replace " + path;
+		return false;
+	}
+
+	return true;
+}
+
+//Bounds-checked access to the sections of a snapshot. Records are copied out, so the data needs no particular alignment.
+class SnapshotReader {
+public:
+	SnapHeader header;
+	string error;
+
+	SnapshotReader(const char* data, size_t size) : data(data), size(size) {}
+
+	//Checks the header and that every section lies within the data
+	bool open() {
+		if (size < sizeof(SnapHeader)) {
+			return fail("shorter than a snapshot header");
+		}
+		memcpy(&header, data, sizeof(header));
+
+		if (memcmp(header.magic, SnapMagic, sizeof(SnapMagic)) != 0) {
+			return fail("not a ruleset snapshot");
+		}
+		if (header.version != RulesetSnapshotVersion) {
+			return fail("format version " + to_string(header.version) + ", expected " + to_string(RulesetSnapshotVersion));
+		}
+		if (header.headerSize != sizeof(SnapHeader)) {
+			return fail("unexpected header size");
+		}
+		if (header.fileSize != size) {
+			return fail("file is " + to_string(size) + " bytes, header says " + to_string(header.fileSize));
+		}
+		if (fnv1a(data + sizeof(SnapHeader), size - sizeof(SnapHeader)) != header.checksum) {
+			return fail("checksum mismatch");
+		}
+
+		for (int i = 0; i < SnapSectionCount; i++) {
+			const SnapTable& t = header.sections[i];
+			if (t.offset % 8 != 0 || t.offset < sizeof(SnapHeader) || (uint64_t)t.offset + (uint64_t)t.count * snapElementSize[i] > size) {
+				return fail("section " + to_string(i) + " out of bounds");
+			}
+		}
+
+		return true;
+	}
+
+	uint32_t count(SnapSection id) const {
+		return header.sections[id].count;
+	}
+
+	template <class T>
+	T record(SnapSection id, uint32_t i) const {
+		T out;
+		memcpy(&out, data + header.sections[id].offset + (size_t)i * sizeof(T), sizeof(T));
+		return out;
+	}
+
+	bool valid(SnapString s) const {
+		return (uint64_t)s.offset + s.length <= count(SnapStrings);
+	}
+
+	bool valid(SnapRange r, SnapSection id) const {
+		return (uint64_t)r.first + r.count <= count(id);
+	}
+
+	string str(SnapString s) const {
+		return string(data + header.sections[SnapStrings].offset + s.offset, s.length);
+	}
+
+	bool fail(const string& message) {
+		error = message;
+		return false;
+	}
+
+private:
+	const char* data;
+	size_t size;
+};
+
+//Checks every record of an opened snapshot, so decoding can trust every offset and index
+static bool validateRecords(SnapshotReader& in) {
+	const uint32_t airportCount = in.count(SnapAirports);
+
+	if (!in.valid(in.header.etag) || !in.valid(in.header.lastModified)) {
+		return in.fail("header strings out of bounds");
+	}
+
+	for (uint32_t i = 0; i < in.count(SnapNames); i++) {
+		if (!in.valid(in.record<SnapString>(SnapNames, i))) {
+			return in.fail("name " + to_string(i) + " out of bounds");
+		}
+	}
+
+	for (uint32_t i = 0; i < in.count(SnapPatterns); i++) {
+		if (!in.valid(in.record<SnapPattern>(SnapPatterns, i).tokens, SnapWords32)) {
+			return in.fail("route pattern " + to_string(i) + " out of bounds");
+		}
+	}
+
+	for (uint32_t i = 0; i < in.count(SnapRestrictions); i++) {
+		SnapRestriction r = in.record<SnapRestriction>(SnapRestrictions, i);
+		if (!in.valid(r.typeCodes) || !in.valid(r.types, SnapNames) || !in.valid(r.suffix, SnapNames) || !in.valid(r.alt, SnapNames) || !in.valid(r.window, SnapWords64)
+			|| r.flags > (SnapDate | SnapTime) || r.window.count != (r.flags ? SnapWindowWords : 0)) {
+			return in.fail("restriction " + to_string(i) + " invalid");
+		}
+	}
+
+	for (uint32_t i = 0; i < in.count(SnapConstraints); i++) {
+		SnapConstraint c = in.record<SnapConstraint>(SnapConstraints, i);
+		if (!in.valid(c.dests, SnapNames) || !in.valid(c.nodests, SnapNames) || !in.valid(c.route, SnapNames) || !in.valid(c.noroute, SnapNames)
+			|| !in.valid(c.points, SnapNames) || !in.valid(c.nopoints, SnapNames) || !in.valid(c.destPrefixes.longer, SnapNames) || !in.valid(c.nodestPrefixes.longer, SnapNames)
+			|| !in.valid(c.destPrefixes.packed, SnapWords32) || !in.valid(c.nodestPrefixes.packed, SnapWords32) || !in.valid(c.pointIds, SnapWords32) || !in.valid(c.nopointIds, SnapWords32)
+			|| !in.valid(c.routePatterns, SnapPatterns) || !in.valid(c.noroutePatterns, SnapPatterns) || !in.valid(c.restrictions, SnapRestrictions) || !in.valid(c.nav)
+			|| c.flags > (SnapHasNav | SnapHasMin | SnapHasMax | SnapOverride) || c.dir > (uint32_t)LevelDirection::Other) {
+			return in.fail("constraint " + to_string(i) + " invalid");
+		}
+	}
+
+	for (uint32_t i = 0; i < in.count(SnapSids); i++) {
+		SnapSid s = in.record<SnapSid>(SnapSids, i);
+		if (!in.valid(s.point) || !in.valid(s.restrictions, SnapRestrictions) || !in.valid(s.constraints, SnapConstraints) || !in.valid(s.masks, SnapWords64)
+			|| s.masks.count != (1 + ConstraintRounds) * ((s.constraints.count + 63) / 64)) {
+			return in.fail("SID " + to_string(i) + " invalid");
+		}
+	}
+
+	for (uint32_t i = 0; i < airportCount; i++) {
+		SnapAirport a = in.record<SnapAirport>(SnapAirports, i);
+		if (!in.valid(a.icao) || !in.valid(a.sids, SnapSids) || !in.valid(a.sidIndex, SnapSidIndex) || !in.valid(a.sidAliases, SnapSidAliases)) {
+			return in.fail("airport " + to_string(i) + " invalid");
+		}
+
+		for (uint32_t j = a.sidIndex.first; j < a.sidIndex.first + a.sidIndex.count; j++) {
+			SnapEntry e = in.record<SnapEntry>(SnapSidIndex, j);
+			if (!in.valid(e.name) || e.value >= a.sids.count) {
+				return in.fail("SID index of airport " + to_string(i) + " invalid");
+			}
+		}
+
+		for (uint32_t j = a.sidAliases.first; j < a.sidAliases.first + a.sidAliases.count; j++) {
+			SnapPair p = in.record<SnapPair>(SnapSidAliases, j);
+			if (!in.valid(p.key) || !in.valid(p.value)) {
+				return in.fail("SID aliases of airport " + to_string(i) + " invalid");
+			}
+		}
+	}
+
+	//SidRuleset::find probes until it reaches an empty slot, so the table must have one
+	uint32_t slotCount = in.count(SnapSlots);
+	if (slotCount) {
+		bool empty = false;
+		for (uint32_t i = 0; i < slotCount; i++) {
+			SnapSlot s = in.record<SnapSlot>(SnapSlots, i);
+			if (s.key == 0) {
+				empty = true;
+			}
+			else if (s.airport >= airportCount) {
+				return in.fail("airport slot " + to_string(i) + " invalid");
+			}
+		}
+
+		if ((slotCount & (slotCount - 1)) != 0 || in.header.slotShift == 0 || in.header.slotShift >= 32 || slotCount != 1u << (32 - in.header.slotShift) || !empty) {
+			return in.fail("airport table invalid");
+		}
+	}
+
+	const SnapSection entrySections[] = { SnapOtherAirports, SnapRouteTokens, SnapWaypoints };
+	for (SnapSection id : entrySections) {
+		for (uint32_t i = 0; i < in.count(id); i++) {
+			SnapEntry e = in.record<SnapEntry>(id, i);
+			if (!in.valid(e.name) || (id == SnapOtherAirports && e.value >= airportCount)) {
+				return in.fail("lookup table entry " + to_string(i) + " invalid");
+			}
+		}
+	}
+
+	return true;
+}
+
+bool validateRulesetSnapshot(const char* data, size_t size, string& error) {
+	SnapshotReader in(data, size);
+
+	if (!in.open() || !validateRecords(in)) {
+		error = in.error;
+		return false;
+	}
+
+	return true;
+}
+
+//Rebuilds compiled rules from a validated snapshot. Only copies - nothing is parsed, interned or evaluated again.
+class SnapshotDecoder {
+public:
+	SnapshotDecoder(const SnapshotReader& in) : in(in) {}
+
+	vector<string> nameList(SnapRange r) const {
+		vector<string> out;
+		out.reserve(r.count);
+		for (uint32_t i = 0; i < r.count; i++) {
+			out.push_back(in.str(in.record<SnapString>(SnapNames, r.first + i)));
+		}
+		return out;
+	}
+
+	template <class T>
+	void wordList(SnapRange r, T& out) const {
+		out.clear();
+		for (uint32_t i = 0; i < r.count; i++) {
+			out.push_back(in.record<uint32_t>(SnapWords32, r.first + i));
+		}
+	}
+
+	void words(SnapRange r, uint32_t skip, ConstraintMask& out) const {
+		for (size_t i = 0; i < out.words.size(); i++) {
+			out.words[i] = in.record<uint64_t>(SnapWords64, r.first + skip + (uint32_t)i);
+		}
+	}
+
+	std::shared_ptr<const bitset<MinutesPerWeek>> window(SnapRange r) const {
+		std::shared_ptr<bitset<MinutesPerWeek>> out = std::make_shared<bitset<MinutesPerWeek>>();
+		for (uint32_t i = SnapWindowWords; i-- > 0;) {
+			*out <<= 64;
+			*out |= bitset<MinutesPerWeek>(in.record<uint64_t>(SnapWords64, r.first + i));
+		}
+		return out;
+	}
+
+	DestinationPrefixes prefixes(const SnapPrefixes& p) const {
+		DestinationPrefixes out;
+		wordList(p.packed, out.packed);
+		out.lengths = p.lengths;
+		out.longer = nameList(p.longer);
+		return out;
+	}
+
+	vector<RoutePattern> patternList(SnapRange r) const {
+		vector<RoutePattern> out(r.count);
+		for (uint32_t i = 0; i < r.count; i++) {
+			SnapPattern p = in.record<SnapPattern>(SnapPatterns, r.first + i);
+			wordList(p.tokens, out[i].tokens);
+			out[i].any = p.any != 0;
+		}
+		return out;
+	}
+
+	vector<SidRestriction> restrictionList(SnapRange r) const {
+		vector<SidRestriction> out(r.count);
+		for (uint32_t i = 0; i < r.count; i++) {
+			SnapRestriction s = in.record<SnapRestriction>(SnapRestrictions, r.first + i);
+			SidRestriction& rest = out[i];
+			rest.typeCodes = in.str(s.typeCodes);
+			rest.types = nameList(s.types);
+			rest.suffix = nameList(s.suffix);
+			rest.alt = nameList(s.alt);
+			rest.date = (s.flags & SnapDate) != 0;
+			rest.time = (s.flags & SnapTime) != 0;
+			rest.startDate = s.startDate;
+			rest.endDate = s.endDate;
+			rest.startTime[0] = s.startTime[0];
+			rest.startTime[1] = s.startTime[1];
+			rest.endTime[0] = s.endTime[0];
+			rest.endTime[1] = s.endTime[1];
+			if (s.flags) {
+				rest.window = window(s.window);
+			}
+		}
+		return out;
+	}
+
+	vector<SidConstraint> constraintList(SnapRange r) const {
+		vector<SidConstraint> out(r.count);
+		for (uint32_t i = 0; i < r.count; i++) {
+			SnapConstraint s = in.record<SnapConstraint>(SnapConstraints, r.first + i);
+			SidConstraint& con = out[i];
+			con.dests = nameList(s.dests);
+			con.nodests = nameList(s.nodests);
+			con.destPrefixes = prefixes(s.destPrefixes);
+			con.nodestPrefixes = prefixes(s.nodestPrefixes);
+			con.route = nameList(s.route);
+			con.noroute = nameList(s.noroute);
+			con.routePatterns = patternList(s.routePatterns);
+			con.noroutePatterns = patternList(s.noroutePatterns);
+			con.points = nameList(s.points);
+			con.nopoints = nameList(s.nopoints);
+			wordList(s.pointIds, con.pointIds);
+			wordList(s.nopointIds, con.nopointIds);
+			con.hasNav = (s.flags & SnapHasNav) != 0;
+			con.nav = in.str(s.nav);
+			con.hasMin = (s.flags & SnapHasMin) != 0;
+			con.hasMax = (s.flags & SnapHasMax) != 0;
+			con.min = s.min;
+			con.max = s.max;
+			con.dir = (LevelDirection)s.dir;
+			con.override = (s.flags & SnapOverride) != 0;
+			con.restrictions = restrictionList(s.restrictions);
+		}
+		return out;
+	}
+
+	vector<SidRule> sidList(SnapRange r) const {
+		vector<SidRule> out(r.count);
+		for (uint32_t i = 0; i < r.count; i++) {
+			SnapSid s = in.record<SnapSid>(SnapSids, r.first + i);
+			SidRule& sid = out[i];
+			sid.point = in.str(s.point);
+			sid.hasConstraints = s.hasConstraints != 0;
+			sid.restrictions = restrictionList(s.restrictions);
+			sid.constraints = constraintList(s.constraints);
+
+			size_t maskWords = (s.constraints.count + 63) / 64;
+			sid.all = ConstraintMask(s.constraints.count);
+			words(s.masks, 0, sid.all);
+			for (size_t round = 0; round < ConstraintRounds; round++) {
+				sid.alwaysPass[round] = ConstraintMask(s.constraints.count);
+				words(s.masks, (uint32_t)((round + 1) * maskWords), sid.alwaysPass[round]);
+			}
+		}
+		return out;
+	}
+
+	//Entries were written in key order, so each insert goes at the end
+	template <class M>
+	void entries(SnapSection id, SnapRange r, M& out) const {
+		for (uint32_t i = 0; i < r.count; i++) {
+			SnapEntry e = in.record<SnapEntry>(id, r.first + i);
+			out.emplace_hint(out.end(), in.str(e.name), e.value);
+		}
+	}
+
+	void ruleset(SidRuleset& out) const {
+		out.airports.resize(in.count(SnapAirports));
+		for (uint32_t i = 0; i < in.count(SnapAirports); i++) {
+			SnapAirport a = in.record<SnapAirport>(SnapAirports, i);
+			AirportRules& rules = out.airports[i];
+			rules.icao = in.str(a.icao);
+			rules.hasSids = a.hasSids != 0;
+			rules.sids = sidList(a.sids);
+			entries(SnapSidIndex, a.sidIndex, rules.sidIndex);
+
+			for (uint32_t j = 0; j < a.sidAliases.count; j++) {
+				SnapPair p = in.record<SnapPair>(SnapSidAliases, a.sidAliases.first + j);
+				rules.sidAliases.emplace_hint(rules.sidAliases.end(), in.str(p.key), in.str(p.value));
+			}
+		}
+
+		out.slots.resize(in.count(SnapSlots));
+		for (uint32_t i = 0; i < in.count(SnapSlots); i++) {
+			SnapSlot s = in.record<SnapSlot>(SnapSlots, i);
+			out.slots[i].key = s.key;
+			out.slots[i].airport = s.airport;
+		}
+		out.slotShift = in.header.slotShift;
+
+		out.otherAirports.clear();
+		out.routeTokens.clear();
+		out.waypoints.clear();
+		entries(SnapOtherAirports, SnapRange{ 0, in.count(SnapOtherAirports) }, out.otherAirports);
+		entries(SnapRouteTokens, SnapRange{ 0, in.count(SnapRouteTokens) }, out.routeTokens);
+		entries(SnapWaypoints, SnapRange{ 0, in.count(SnapWaypoints) }, out.waypoints);
+		out.longestRoutePattern = in.header.longestRoutePattern;
+	}
+
+private:
+	const SnapshotReader& in;
+};
+
+bool readRulesetSnapshot(const char* data, size_t size, SidRuleset& out, RulesetSnapshotInfo& info, string& error) {
+	SnapshotReader in(data, size);
+
+	if (!in.open() || !validateRecords(in)) {
+		error = in.error;
+		return false;
+	}
+
+	SnapshotDecoder(in).ruleset(out);
+	info.etag = in.str(in.header.etag);
+	info.lastModified = in.str(in.header.lastModified);
+	info.fetched = in.header.fetched;
+
+	return true;
+}
+
+//Read-only view of a whole file, unmapped when destroyed
+class MappedFile {
+public:
+	MappedFile() : view(nullptr), length(0) {}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+#ifdef _WIN32
+	~MappedFile() {
+		if (view != nullptr) {
+			UnmapViewOfFile(view);
+		}
+		if (mapping != nullptr) {
+			CloseHandle(mapping);
+		}
+		if (file != INVALID_HANDLE_VALUE) {
+			CloseHandle(file);
+		}
+	}
+
+	bool open(const string& path) {
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size;
+		if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			return false;
+		}
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			return false;
+		}
+
+		view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		length = (size_t)size.QuadPart;
+		return view != nullptr;
+	}
+#else
+	~MappedFile() {
+		if (view != nullptr) {
+			munmap((void*)view, length);
+		}
+	}
+
+	bool open(const string& path) {
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			close(fd);
+			return false;
+		}
+
+		void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (mapped == MAP_FAILED) {
+			return false;
+		}
+
+		view = (const char*)mapped;
+		length = (size_t)st.st_size;
+		return true;
+	}
+#endif
+
+	const char* data() const {
+		return view;
+	}
+
+	size_t size() const {
+		return length;
+	}
+
+private:
+	const char* view;
+	size_t length;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+};
+
+bool loadRulesetSnapshot(const string& path, SidRuleset& out, RulesetSnapshotInfo& info, size_t& mapped, string& error) {
+	MappedFile file;
+	mapped = 0;
+
+	if (!file.open(path)) {
+		error = "could not map " + path;
+		return false;
+	}
+
+	mapped = file.size();
+	return readRulesetSnapshot(file.data(), file.size(), out, info, error);
+}
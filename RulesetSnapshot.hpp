@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Ruleset.hpp"
+
+using namespace std;
+
+//Format version of snapshot files, older or newer files are rejected and rebuilt from JSON
+const uint32_t RulesetSnapshotVersion = 1;
+
+//Origin of the rules in a snapshot, stored alongside them
+struct RulesetSnapshotInfo {
+	string etag;			//Validators of the API response the rules were compiled from
+	string lastModified;
+	int64_t fetched = 0;	//Unix time the data was downloaded, 0 if not from the API
+};
+
+//Encodes compiled rules as a snapshot: a header followed by flat record arrays that refer to each other by index and to a shared string table by offset.
+//Holds no pointers, so it can be mapped at any address and read without parsing.
+void encodeRulesetSnapshot(const SidRuleset& rules, const RulesetSnapshotInfo& info, vector<char>& out);
+
+//Encodes rules into path, written to path + ".tmp" first so an incomplete file never replaces a good one
+bool writeRulesetSnapshot(const string& path, const SidRuleset& rules, const RulesetSnapshotInfo& info, string& error);
+
+//Checks that data is a complete snapshot of the current version, and that every offset and index in it is in range
+bool validateRulesetSnapshot(const char* data, size_t size, string& error);
+
+//Validates a snapshot held in memory and decodes it into out
+bool readRulesetSnapshot(const char* data, size_t size, SidRuleset& out, RulesetSnapshotInfo& info, string& error);
+
+//Maps a snapshot file read-only, validates it and decodes it into out, a copy on the heap: the file is unmapped before returning.
+//mapped is set to the file size.
+bool loadRulesetSnapshot(const string& path, SidRuleset& out, RulesetSnapshotInfo& info, size_t& mapped, string& error);
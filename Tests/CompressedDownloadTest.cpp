@@ -0,0 +1,84 @@
+//Compressed download against a stand-in API: a gzip'd response must be requested, decoded as it arrives and compile to the same rules
+#include "HttpClient.hpp"
+#include "Ruleset.hpp"
+#include "StandInServer.hpp"
+#include <iostream>
+#include <zlib.h>
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+	if (!condition) {
+		cerr << "FAILED: " << what << "\n";
+		failures++;
+	}
+}
+
+static string gzip(const string& data) {
+	z_stream stream = {};
+	deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+
+	string out(deflateBound(&stream, (uLong)data.size()) + 32, '\0');
+	stream.next_in = (Bytef*)data.data();
+	stream.avail_in = (uInt)data.size();
+	stream.next_out = (Bytef*)&out[0];
+	stream.avail_out = (uInt)out.size();
+	deflate(&stream, Z_FINISH);
+	out.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	return out;
+}
+
+int main() {
+	if (!HttpClient::decodesCompression()) {
+		cerr << "libcurl was built without zlib, skipped\n";
+		return 77;
+	}
+
+	//Repetitive like the real data, with a distinct ICAO per airport
+	string json = "[";
+	for (int i = 0; i < 40; i++) {
+		json += string(i ? ", " : "") + "{\"icao\": \"EG" + (char)('A' + i / 26) + (char)('A' + i % 26) + "\", \"sids\": [{\"point\": \"LAM\", \"constraints\": [{\"dests\": [\"EG\", \"LF\"], \"route\": [\"L6 DVR\"], \"min\": 70, \"dir\": \"ODD\"}]}]}";
+	}
+	json += "]";
+	string compressed = gzip(json);
+
+	StandInServer server(StandInPort, [&](const StandInRequest& request) {
+		StandInResponse response;
+		map<string, string>::const_iterator accepted = request.headers.find("accept-encoding");
+
+		if (accepted != request.headers.end() && accepted->second.find("gzip") != string::npos) {
+			response.headers.push_back("Content-Encoding: gzip");
+			response.body = compressed;
+		}
+		else {
+			response.body = json;
+		}
+
+		return response;
+	});
+
+	if (!server.ok()) {
+		cerr << "Could not listen on port " << StandInPort << "\n";
+		return 1;
+	}
+
+	HttpClient client;
+	HttpRequest request;
+	request.url = "http://127.0.0.1:" + to_string(StandInPort) + "/mongoFull";
+	client.get(request);
+
+	check(request.status == 200, "request succeeded");
+	check(server.received().size() == 1 && server.received()[0].headers.count("accept-encoding") == 1, "Accept-Encoding was sent");
+	check(request.encoding == "gzip", "response was gzip encoded");
+	check(request.transferred == compressed.size(), "transferred size is the compressed size");
+	check(request.body == json, "body was decoded");
+	cout << json.size() << " bytes sent as " << compressed.size() << " bytes gzip\n";
+
+	SidRuleset rules;
+	vector<RulesetIssue> issues;
+	check(compileRulesetStream(&request.body[0], rules, issues) && rules.airports.size() == 40, "decoded body compiles");
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+//Conditional download of the SID data against a stand-in API: a 304 must leave the published rules untouched,
+//and dropping the validators (.vfpc file, then .vfpc load) must make the next download unconditional, even while a conditional one is in flight
+#include "stdafx.h"
+#include "analyzeFP.hpp"
+#include "EuroScopeStub.hpp"
+#include "StandInServer.hpp"
+#include <cstdlib>
+#include <future>
+
+//Exposes what the test inspects
+class TestPlugin : public CVFPCPlugin {
+public:
+	using CVFPCPlugin::rulesGeneration;
+	using CVFPCPlugin::uiRules;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+	if (!condition) {
+		cerr << "FAILED: " << what << "\n";
+		failures++;
+	}
+}
+
+static const string rulesV1 = "[{\"icao\": \"EGKK\", \"sids\": [{\"point\": \"LAM\", \"constraints\": [{\"dests\": [\"EG\"]}]}]}]";
+static const string rulesV2 = "[{\"icao\": \"EGKK\", \"sids\": [{\"point\": \"LAM\", \"constraints\": [{\"dests\": [\"EG\"]}]}]}, {\"icao\": \"EGLL\", \"sids\": [{\"point\": \"CPT\"}]}]";
+
+int main() {
+	char directory[] = "/tmp/vfpc-test-XXXXXX";
+	if (mkdtemp(directory) == nullptr) {
+		cerr << "Could not create a plugin directory\n";
+		return 1;
+	}
+	stubPluginDirectory = directory;
+
+	mutex served;
+	string etag = "\"v1\"";
+	string body = rulesV1;
+	atomic<bool> delayNotModified(false);
+	atomic<bool> delaying(false);
+
+	StandInServer server(StandInPort, [&](const StandInRequest& request) {
+		unique_lock<mutex> lock(served);
+		StandInResponse response;
+
+		if (request.path == "/version") {
+			response.body = "{\"VFPC_Version\": \"0.0.0\"}";
+		}
+		else if (request.path == "/mongoFull") {
+			map<string, string>::const_iterator match = request.headers.find("if-none-match");
+			if (match != request.headers.end() && match->second == etag) {
+				response.status = 304;
+
+				//Holds the 304 back while the test issues commands, the server lock is released meanwhile
+				if (delayNotModified) {
+					lock.unlock();
+					delaying = true;
+					this_thread::sleep_for(chrono::milliseconds(800));
+				}
+			}
+			else {
+				response.headers.push_back("ETag: " + etag);
+				response.body = body;
+			}
+		}
+		else {
+			response.status = 404;
+		}
+
+		return response;
+	});
+
+	if (!server.ok()) {
+		cerr << "Could not listen on port " << StandInPort << "\n";
+		return 1;
+	}
+
+	TestPlugin* plugin = new TestPlugin();
+
+	//First download is unconditional and publishes the rules
+	plugin->runWebCalls();
+	vector<StandInRequest> requests = server.received();
+	check(requests.size() == 2, "version and SID data requested");
+	check(requests.back().path == "/mongoFull" && requests.back().headers.count("if-none-match") == 0, "first download is unconditional");
+	check(plugin->rulesGeneration == 1, "first download publishes generation 1");
+	std::shared_ptr<const SidRuleset> first = plugin->readRules(plugin->uiRules);
+	check(first->airports.size() == 1, "first download has 1 airport");
+
+	//Unchanged data: 304, rules untouched
+	plugin->runWebCalls();
+	requests = server.received();
+	check(requests.back().headers["if-none-match"] == "\"v1\"", "second download sends If-None-Match");
+	check(plugin->rulesGeneration == 1, "304 keeps the generation");
+	check(plugin->readRules(plugin->uiRules) == first, "304 keeps the published rules");
+
+	//Switching to Sid.json and back drops the validators, so the next download is unconditional
+	{
+		ofstream file(string(directory) + "/Sid.json");
+		file << rulesV2;
+	}
+	plugin->OnCompileCommand(".vfpc file");
+	check(plugin->rulesGeneration == 2 && plugin->readRules(plugin->uiRules)->airports.size() == 2, "Sid.json is published");
+	plugin->OnCompileCommand(".vfpc load");
+	plugin->runWebCalls();
+	requests = server.received();
+	check(requests.back().headers.count("if-none-match") == 0, "download after .vfpc load is unconditional");
+	check(plugin->rulesGeneration == 3 && plugin->readRules(plugin->uiRules)->airports.size() == 1, "API data replaces Sid.json");
+
+	//Changed data: 200 with a new ETag, published
+	{
+		lock_guard<mutex> lock(served);
+		etag = "\"v2\"";
+		body = rulesV2;
+	}
+	plugin->runWebCalls();
+	check(plugin->rulesGeneration == 4 && plugin->readRules(plugin->uiRules)->airports.size() == 2, "changed data is published");
+
+	//Validators dropped while a conditional download is in flight: its 304 is discarded and the data downloaded again in full after the batch,
+	//not from inside it, where the nested request would deadlock on the client and leave loadMutex held
+	{
+		lock_guard<mutex> lock(served);
+		body = rulesV1;
+		delayNotModified = true;
+	}
+	future<void> inFlight = async(launch::async, [plugin]() {
+		plugin->runWebCalls();
+	});
+	while (!delaying) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	plugin->OnCompileCommand(".vfpc file");
+	check(plugin->rulesGeneration == 5, "Sid.json is published while the download is in flight");
+	plugin->OnCompileCommand(".vfpc load");
+
+	if (inFlight.wait_for(chrono::seconds(5)) != future_status::ready) {
+		cerr << "FAILED: download with dropped validators did not complete within 5 s\n";
+		_exit(1);
+	}
+	delayNotModified = false;
+	requests = server.received();
+	size_t previous = requests.size() - 1;
+	while (previous > 0 && requests[--previous].path != "/mongoFull") {}
+	check(requests[previous].path == "/mongoFull" && requests[previous].headers["if-none-match"] == "\"v2\"", "in-flight download was conditional");
+	check(requests.back().path == "/mongoFull" && requests.back().headers.count("if-none-match") == 0, "download after the discarded 304 is unconditional");
+	check(plugin->rulesGeneration == 6 && plugin->readRules(plugin->uiRules)->airports.size() == 1, "full body replaces Sid.json");
+
+	//A 304 to a request made without validators is a failure, not a write through a null pointer
+	HttpRequest unconditional;
+	unconditional.status = 304;
+	unconditional.headers.push_back("If-None-Match: \"v2\"");
+	check(!plugin->webResult(unconditional), "304 without validators is not a success");
+
+	delete plugin;
+
+	if (failures) {
+		for (const string& message : stubMessages) {
+			cerr << message << "\n";
+		}
+	}
+
+	string cleanup = string("rm -rf ") + directory;
+	system(cleanup.c_str());
+
+	return failures ? 1 : 0;
+}
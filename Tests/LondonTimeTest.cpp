@@ -0,0 +1,88 @@
+//Europe/London time around the DST transitions, checked against values from the IANA tz database
+#include "LondonTime.hpp"
+#include "Ruleset.hpp"
+#include <iostream>
+#include <string>
+#include <boost/format.hpp>
+
+using namespace std;
+
+static int failures = 0;
+
+struct LondonCase {
+	const char* utc;
+	UnixTime time;
+	int weekday;	//0 = Sunday
+	int hour;
+	int minute;
+	bool summer;
+};
+
+static const LondonCase cases[] = {
+	//Last Sunday of March on the 25th and the 31st, and this year
+	{ "2018-03-25 00:59", 1521939540, 0, 0, 59, false },
+	{ "2018-03-25 01:00", 1521939600, 0, 2, 0, true },
+	{ "2024-03-31 00:59", 1711846740, 0, 0, 59, false },
+	{ "2024-03-31 01:00", 1711846800, 0, 2, 0, true },
+	{ "2026-03-29 00:59", 1774745940, 0, 0, 59, false },
+	{ "2026-03-29 01:00", 1774746000, 0, 2, 0, true },
+	//Last Sunday of October on the 25th and the 31st, and this year. The local hour from 01:00 repeats.
+	{ "2020-10-25 00:59", 1603587540, 0, 1, 59, true },
+	{ "2020-10-25 01:00", 1603587600, 0, 1, 0, false },
+	{ "2021-10-31 00:59", 1635641940, 0, 1, 59, true },
+	{ "2021-10-31 01:00", 1635642000, 0, 1, 0, false },
+	{ "2026-10-25 00:59", 1792889940, 0, 1, 59, true },
+	{ "2026-10-25 01:00", 1792890000, 0, 1, 0, false },
+	//Year boundary
+	{ "2025-12-31 23:59", 1767225540, 3, 23, 59, false },
+	{ "2026-01-01 00:00", 1767225600, 4, 0, 0, false },
+	//Week boundary: last minute of the week in winter, and Saturday UTC that is already Sunday in summer
+	{ "2018-03-24 23:59", 1521935940, 6, 23, 59, false },
+	{ "2020-10-24 23:30", 1603582200, 0, 0, 30, true },
+};
+
+int main() {
+	for (const LondonCase& c : cases) {
+		int expected = (c.weekday * 24 + c.hour) * 60 + c.minute;
+		int actual = londonMinuteOfWeek(c.time);
+
+		if (actual != expected || britishSummerTime(c.time) != c.summer) {
+			cerr << boost::format("FAILED: %s UTC gave day %i %02i:%02i%s, expected day %i %02i:%02i%s\n") % c.utc
+				% (actual / 1440) % (actual / 60 % 24) % (actual % 60) % (britishSummerTime(c.time) ? " BST" : "")
+				% c.weekday % c.hour % c.minute % (c.summer ? " BST" : "");
+			failures++;
+		}
+	}
+
+	//Minute by minute from 2015 to 2035, local time only jumps at the two transitions of each year: +1 hour in March, -1 hour in October
+	UnixTime start = 1420070400;	//2015-01-01 00:00 UTC
+	UnixTime end = 2082758400;		//2036-01-01 00:00 UTC
+	int previous = londonMinuteOfWeek(start);
+	int forward = 0;
+	int back = 0;
+
+	for (UnixTime t = start + 60; t < end; t += 60) {
+		int current = londonMinuteOfWeek(t);
+		int step = (current - previous + MinutesPerWeek) % MinutesPerWeek;
+
+		if (step == 61) {
+			forward++;
+		}
+		else if (step == MinutesPerWeek - 59) {
+			back++;
+		}
+		else if (step != 1) {
+			cerr << boost::format("FAILED: local time stepped by %i minutes at %i\n") % step % t;
+			failures++;
+		}
+
+		previous = current;
+	}
+
+	if (forward != 21 || back != 21) {
+		cerr << boost::format("FAILED: %i spring and %i autumn transitions from 2015 to 2035, expected 21 each\n") % forward % back;
+		failures++;
+	}
+
+	return failures ? 1 : 0;
+}
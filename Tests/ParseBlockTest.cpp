@@ -0,0 +1,122 @@
+//Load reporting and parse block sizing: every load logs its time and peak memory, and a DOM load that overflows
+//the parse block grows it so the next load of the same data fits in one chunk
+#include "stdafx.h"
+#include "analyzeFP.hpp"
+#include "EuroScopeStub.hpp"
+#include <cstdlib>
+
+//Exposes what the test inspects
+class TestPlugin : public CVFPCPlugin {
+public:
+	using CVFPCPlugin::parseBlock;
+	using CVFPCPlugin::parseBlockSize;
+	using CVFPCPlugin::uiRules;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+	if (!condition) {
+		cerr << "FAILED: " << what << "\n";
+		failures++;
+	}
+}
+
+//Well over the default 64 KiB of parse block once parsed into a DOM
+static string generateRules(int airports) {
+	string json = "[";
+	for (int i = 0; i < airports; i++) {
+		string icao = str(boost::format("E%03i") % i);
+		json += (i ? ", " : "") + string("{\"icao\": \"") + icao + "\", \"sids\": [";
+		for (int j = 0; j < 8; j++) {
+			json += str(boost::format("%s{\"point\": \"P%02i%02i\", \"constraints\": [{\"dests\": [\"EG\", \"EH\", \"LF\"], \"points\": [\"A%02i\", \"B%02i\"], \"min\": 70, \"max\": 250}]}")
+				% (j ? ", " : "") % (i % 100) % j % j % j);
+		}
+		json += "]}";
+	}
+
+	return json + "]";
+}
+
+//Load reports logged since the given message, as the numbers after "peak" and "further pool chunks"
+struct LoadReport {
+	size_t peak;
+	size_t further;
+	size_t next;
+};
+
+static vector<LoadReport> loadReports(size_t from) {
+	vector<LoadReport> reports;
+	for (size_t i = from; i < stubMessages.size(); i++) {
+		LoadReport report;
+		size_t text, block;
+		size_t at = stubMessages[i].find(", peak ");
+		if (at != string::npos && sscanf(stubMessages[i].c_str() + at, ", peak %zu bytes (%zu text, %zu parse block, %zu further pool chunks), next parse block %zu bytes",
+			&report.peak, &text, &block, &report.further, &report.next) == 5) {
+			reports.push_back(report);
+		}
+	}
+
+	return reports;
+}
+
+int main() {
+	char directory[] = "/tmp/vfpc-test-XXXXXX";
+	if (mkdtemp(directory) == nullptr) {
+		cerr << "Could not create a plugin directory\n";
+		return 1;
+	}
+	stubPluginDirectory = directory;
+
+	string rules = generateRules(400);
+	{
+		ofstream file(string(directory) + "/Sid.json");
+		file << rules;
+	}
+
+	TestPlugin* plugin = new TestPlugin();
+	size_t initialBlock = plugin->parseBlockSize;
+
+	plugin->OnCompileCommand(".vfpc log");
+
+	//The streaming loader doesn't use the pool, so it is reported but leaves the block alone
+	size_t from = stubMessages.size();
+	plugin->OnCompileCommand(".vfpc file");
+	vector<LoadReport> reports = loadReports(from);
+	check(reports.size() == 1, "streamed load is reported");
+	check(plugin->parseBlockSize == initialBlock, "streamed load keeps the parse block size");
+	check(plugin->readRules(plugin->uiRules)->airports.size() == 400, "streamed load compiles 400 airports");
+
+	//The first DOM load overflows the default block and sizes the next one from the pool it used
+	plugin->OnCompileCommand(".vfpc stream");
+	from = stubMessages.size();
+	plugin->OnCompileCommand(".vfpc file");
+	reports = loadReports(from);
+	check(reports.size() == 1, "first DOM load is reported");
+	check(!reports.empty() && reports[0].further > 0, "first DOM load allocates beyond the parse block");
+	check(plugin->parseBlockSize > initialBlock, "first DOM load grows the parse block size");
+	check(!reports.empty() && reports[0].peak >= rules.size() + initialBlock + reports[0].further, "peak counts the text, parse block and further chunks");
+
+	//The same data now fits in the grown block
+	size_t grownSize = plugin->parseBlockSize;
+	from = stubMessages.size();
+	plugin->OnCompileCommand(".vfpc file");
+	reports = loadReports(from);
+	check(reports.size() == 1, "second DOM load is reported");
+	check(plugin->parseBlock.size() == grownSize, "second DOM load uses the grown parse block");
+	check(!reports.empty() && reports[0].further == 0, "second DOM load fits in the parse block");
+	check(plugin->readRules(plugin->uiRules)->airports.size() == 400, "DOM load compiles 400 airports");
+
+	delete plugin;
+
+	if (failures) {
+		for (const string& message : stubMessages) {
+			cerr << message << "\n";
+		}
+	}
+
+	string cleanup = string("rm -rf ") + directory;
+	system(cleanup.c_str());
+
+	return failures ? 1 : 0;
+}
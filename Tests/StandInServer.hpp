@@ -0,0 +1,132 @@
+#pragma once
+#include <string>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <boost/algorithm/string.hpp>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace std;
+
+//Request received by the stand-in server. Header names are lower case.
+struct StandInRequest {
+	string path;
+	map<string, string> headers;
+};
+
+struct StandInResponse {
+	int status = 200;
+	vector<string> headers;
+	string body;
+};
+
+//Single-threaded HTTP/1.1 server on 127.0.0.1 that answers each request with handler, then closes the connection.
+//Stands in for the API in tests, so they need no network access.
+class StandInServer {
+public:
+	StandInServer(unsigned short port, std::function<StandInResponse(const StandInRequest&)> handler) : handler(handler), stopping(false) {
+		listener = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		listening = ::bind(listener, (sockaddr*)&address, sizeof(address)) == 0 && listen(listener, 8) == 0;
+		if (listening) {
+			worker = thread(&StandInServer::run, this);
+		}
+	}
+
+	~StandInServer() {
+		stopping = true;
+		shutdown(listener, SHUT_RDWR);
+		close(listener);
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+
+	bool ok() const {
+		return listening;
+	}
+
+	//Requests received so far
+	vector<StandInRequest> received() {
+		lock_guard<mutex> lock(receivedMutex);
+		return requests;
+	}
+
+private:
+	void run() {
+		while (!stopping) {
+			int connection = accept(listener, nullptr, nullptr);
+			if (connection < 0) {
+				continue;
+			}
+
+			string data;
+			char buffer[4096];
+			ssize_t read;
+			while (data.find("\r\n\r\n") == string::npos && (read = recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+				data.append(buffer, (size_t)read);
+			}
+
+			StandInRequest request = parse(data);
+			{
+				lock_guard<mutex> lock(receivedMutex);
+				requests.push_back(request);
+			}
+
+			StandInResponse response = handler(request);
+			string out = "HTTP/1.1 " + to_string(response.status) + (response.status == 304 ? " Not Modified" : " OK") + "\r\n";
+			for (const string& header : response.headers) {
+				out += header + "\r\n";
+			}
+			if (response.status != 304) {
+				out += "Content-Length: " + to_string(response.body.size()) + "\r\n";
+			}
+			out += "Connection: close\r\n\r\n" + response.body;
+
+			send(connection, out.data(), out.size(), MSG_NOSIGNAL);
+			close(connection);
+		}
+	}
+
+	static StandInRequest parse(const string& data) {
+		StandInRequest request;
+		vector<string> lines;
+		boost::split(lines, data, boost::is_any_of("\n"));
+
+		if (lines.size()) {
+			vector<string> first;
+			boost::split(first, lines[0], boost::is_any_of(" "));
+			request.path = first.size() > 1 ? first[1] : "";
+		}
+
+		for (size_t i = 1; i < lines.size(); i++) {
+			size_t colon = lines[i].find(':');
+			if (colon != string::npos) {
+				request.headers[boost::to_lower_copy(lines[i].substr(0, colon))] = boost::trim_copy(lines[i].substr(colon + 1));
+			}
+		}
+
+		return request;
+	}
+
+	std::function<StandInResponse(const StandInRequest&)> handler;
+	int listener;
+	bool listening;
+	atomic<bool> stopping;
+	thread worker;
+	mutex receivedMutex;
+	vector<StandInRequest> requests;
+};
@@ -0,0 +1,128 @@
+//Stand-in for EuroScopePlugInDll.lib, so the plugin can be built and driven by tests on Linux. Flight plan accessors return empty data.
+#include "stdafx.h"
+#include "EuroScopePlugIn.h"
+#include "EuroScopeStub.hpp"
+
+using namespace EuroScopePlugIn;
+
+extern "C" IMAGE_DOS_HEADER __ImageBase;
+IMAGE_DOS_HEADER __ImageBase;
+
+string stubPluginDirectory = ".";
+vector<string> stubMessages;
+int stubConnectionType = CONNECTION_TYPE_NO;
+
+CPlugIn::CPlugIn(int, const char*, const char*, const char*, const char*) {
+	m_pPluginData = nullptr;
+}
+
+CPlugIn::~CPlugIn() {
+}
+
+void CPlugIn::DisplayUserMessage(const char* topLevelName, const char* itemName, const char* message, bool, bool, bool, bool, bool) {
+	stubMessages.push_back(string(topLevelName) + "|" + itemName + "|" + message);
+}
+
+void CPlugIn::RegisterTagItemType(const char*, int) {
+}
+
+void CPlugIn::RegisterTagItemFunction(const char*, int) {
+}
+
+int CPlugIn::GetConnectionType() const {
+	return stubConnectionType;
+}
+
+CFlightPlan CPlugIn::FlightPlanSelectASEL() const {
+	return CFlightPlan();
+}
+
+CFlightPlan CPlugIn::FlightPlanSelect(const char*) const {
+	return CFlightPlan();
+}
+
+CFlightPlan CPlugIn::FlightPlanSelectFirst() const {
+	return CFlightPlan();
+}
+
+CFlightPlan CPlugIn::FlightPlanSelectNext(CFlightPlan) const {
+	return CFlightPlan();
+}
+
+void CPlugIn::OpenPopupList(RECT, const char*, int) {
+}
+
+void CPlugIn::AddPopupListElement(const char*, const char*, int, bool, int, bool, bool) {
+}
+
+const char* CFlightPlan::GetCallsign() const {
+	return "";
+}
+
+CFlightPlanData CFlightPlan::GetFlightPlanData() const {
+	return CFlightPlanData();
+}
+
+CFlightPlanExtractedRoute CFlightPlan::GetExtractedRoute() const {
+	return CFlightPlanExtractedRoute();
+}
+
+CFlightPlanControllerAssignedData CFlightPlan::GetControllerAssignedData() const {
+	return CFlightPlanControllerAssignedData();
+}
+
+int CFlightPlan::GetFinalAltitude() const {
+	return 0;
+}
+
+int CFlightPlanControllerAssignedData::GetFinalAltitude() const {
+	return 0;
+}
+
+const char* CFlightPlanData::GetOrigin() const {
+	return "";
+}
+
+const char* CFlightPlanData::GetDestination() const {
+	return "";
+}
+
+const char* CFlightPlanData::GetRoute() const {
+	return "";
+}
+
+const char* CFlightPlanData::GetSidName() const {
+	return "";
+}
+
+const char* CFlightPlanData::GetPlanType() const {
+	return "";
+}
+
+const char* CFlightPlanData::GetAircraftFPType() const {
+	return "";
+}
+
+int CFlightPlanData::GetFinalAltitude() const {
+	return 0;
+}
+
+char CFlightPlanData::GetEngineType() const {
+	return 0;
+}
+
+char CFlightPlanData::GetAircraftType() const {
+	return 0;
+}
+
+char CFlightPlanData::GetCapibilities() const {
+	return 0;
+}
+
+int CFlightPlanExtractedRoute::GetPointsNumber() const {
+	return 0;
+}
+
+const char* CFlightPlanExtractedRoute::GetPointName(int) const {
+	return "";
+}
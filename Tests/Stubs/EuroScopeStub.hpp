@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//Messages passed to CPlugIn::DisplayUserMessage, as "channel|sender|message"
+extern vector<string> stubMessages;
+
+//Returned by CPlugIn::GetConnectionType
+extern int stubConnectionType;
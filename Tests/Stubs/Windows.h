@@ -0,0 +1,66 @@
+#pragma once
+//Stand-in for the parts of the Win32 API used by the plugin sources, so they can be built and tested on Linux
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <ctime>
+#include <string>
+
+#define __declspec(x)
+#define __stdcall
+#define WINAPI
+
+typedef unsigned long DWORD;
+typedef DWORD COLORREF;
+typedef long LONG;
+typedef int BOOL;
+typedef unsigned short WORD;
+typedef unsigned char BYTE;
+typedef long long __int64;
+typedef void* HWND;
+typedef void* HDC;
+typedef void* HINSTANCE;
+typedef void* HMODULE;
+
+struct POINT { LONG x, y; };
+struct RECT { LONG left, top, right, bottom; };
+struct IMAGE_DOS_HEADER { WORD e_magic; };
+
+#define RGB(r, g, b) ((COLORREF)(((BYTE)(r) | ((WORD)((BYTE)(g)) << 8)) | (((DWORD)(BYTE)(b)) << 16)))
+#define _MAX_PATH 260
+#define MAX_PATH 260
+#define MOVEFILE_REPLACE_EXISTING 1
+#define MININT INT_MIN
+#define MAXINT INT_MAX
+
+//EuroScopePlugIn.h uses NULL as a pure specifier and refers to classes before declaring them, both of which only MSVC accepts
+#undef NULL
+#define NULL 0
+namespace EuroScopePlugIn {
+	class CRadarTarget;
+	class CPlugIn;
+}
+
+//Directory the stand-in "VFPC.dll" is in, so tests choose where the plugin keeps its files
+extern std::string stubPluginDirectory;
+
+inline DWORD GetModuleFileNameA(HINSTANCE, char* path, DWORD size) {
+	std::snprintf(path, size, "%s/VFPC.dll", stubPluginDirectory.c_str());
+	return (DWORD)std::strlen(path);
+}
+
+inline int strcpy_s(char* dest, size_t size, const char* src) {
+	std::strncpy(dest, src, size);
+	dest[size - 1] = '\0';
+	return 0;
+}
+
+inline BOOL MoveFileExA(const char* from, const char* to, DWORD) {
+	return std::rename(from, to) == 0;
+}
+
+inline int gmtime_s(struct tm* out, const time_t* t) {
+	return gmtime_r(t, out) ? 0 : 1;
+}
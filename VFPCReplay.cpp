@@ -0,0 +1,249 @@
+//Offline replay of recorded flight plans against SID data, for measuring and profiling the checks outside EuroScope
+//Usage: VFPCReplay <Sid.json|Sid.bin> <plans.ndjson> [--time <unix time>] [--repeat <n>] [--quiet]
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+#include "rapidjson/document.h"
+#include "Ruleset.hpp"
+#include "RulesetSnapshot.hpp"
+#include "FlightPlanCheck.hpp"
+#include "LondonTime.hpp"
+
+using namespace std;
+using namespace rapidjson;
+
+//Recorded flight plan and the line it was read from
+struct ReplayPlan {
+	size_t line;
+	FlightPlanSnapshot plan;
+};
+
+static bool readFile(const string& path, vector<char>& text) {
+	ifstream ifs(path.c_str(), ios::binary | ios::ate);
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	//Terminated for in-situ parsing
+	text.resize((size_t)ifs.tellg() + 1);
+	ifs.seekg(0);
+	ifs.read(&text[0], text.size() - 1);
+	text.back() = '\0';
+
+	return !ifs.fail();
+}
+
+static double millisSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+//Loads a snapshot (.bin) or compiles SID data (anything else) the same way the plugin does
+static bool loadRules(const string& path, SidRuleset& rules) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	if (boost::iends_with(path, ".bin")) {
+		RulesetSnapshotInfo info;
+		size_t mapped = 0;
+		string error;
+
+		if (!loadRulesetSnapshot(path, rules, info, mapped, error)) {
+			cerr << path << ": " << error << "\n";
+			return false;
+		}
+
+		cerr << boost::format("%s: %i airports, %i bytes mapped and decoded in %.2f ms\n") % path % rules.airports.size() % mapped % millisSince(start);
+		return true;
+	}
+
+	vector<char> text;
+	if (!readFile(path, text)) {
+		cerr << path << ": Could not be read\n";
+		return false;
+	}
+
+	vector<RulesetIssue> issues;
+	bool parsed = compileRulesetStream(&text[0], rules, issues);
+
+	for (size_t i = 0; i < issues.size() && i < 10; i++) {
+		cerr << boost::format("%s: %s (Offset: %i)\n") % path % issues[i].message % issues[i].offset;
+	}
+	if (issues.size() > 10) {
+		cerr << boost::format("%s: %i further issues\n") % path % (issues.size() - 10);
+	}
+
+	if (!parsed) {
+		return false;
+	}
+
+	cerr << boost::format("%s: %i airports, %i bytes parsed and compiled in %.2f ms\n") % path % rules.airports.size() % (text.size() - 1) % millisSince(start);
+	return true;
+}
+
+static string stringMember(const Value& object, const char* name) {
+	if (object.HasMember(name) && object[name].IsString()) {
+		return object[name].GetString();
+	}
+
+	return "";
+}
+
+//Aircraft/engine types are single characters, as returned by CFlightPlanData
+static char charMember(const Value& object, const char* name) {
+	string value = stringMember(object, name);
+	return value.empty() ? 0 : value[0];
+}
+
+//Reads one plan per line. Fields mirror the CFlightPlan accessors copied by CVFPCPlugin::getSnapshot:
+//{"callsign", "origin", "dest", "route", "rfl", "sid", "type", "engine", "capabilities", "planType", "points": [...]}
+static bool readPlans(const string& path, vector<ReplayPlan>& plans) {
+	ifstream ifs(path.c_str());
+	if (!ifs.is_open()) {
+		cerr << path << ": Could not be read\n";
+		return false;
+	}
+
+	string line;
+	size_t number = 0;
+	while (getline(ifs, line)) {
+		number++;
+		boost::trim(line);
+
+		if (line.empty()) {
+			continue;
+		}
+
+		Document doc;
+		doc.ParseInsitu<0>(&line[0]);
+
+		if (doc.HasParseError() || !doc.IsObject()) {
+			cerr << boost::format("%s:%i: %s\n") % path % number % (doc.HasParseError() ? doc.GetParseError() : "Not an object");
+			continue;
+		}
+
+		ReplayPlan replay;
+		replay.line = number;
+		FlightPlanSnapshot& plan = replay.plan;
+
+		plan.callsign = stringMember(doc, "callsign");
+		plan.origin = stringMember(doc, "origin");
+		plan.destination = stringMember(doc, "dest");
+		plan.route = stringMember(doc, "route");
+		plan.finalAltitude = doc.HasMember("rfl") && doc["rfl"].IsInt() ? doc["rfl"].GetInt() : 0;
+		plan.sidName = stringMember(doc, "sid");
+		plan.aircraftType = charMember(doc, "type");
+		plan.engineType = charMember(doc, "engine");
+		plan.capabilities = charMember(doc, "capabilities");
+		plan.planType = stringMember(doc, "planType");
+
+		if (doc.HasMember("points") && doc["points"].IsArray()) {
+			const Value& points = doc["points"];
+			for (SizeType i = 0; i < points.Size(); i++) {
+				if (points[i].IsString()) {
+					plan.points.push_back(points[i].GetString());
+				}
+			}
+		}
+
+		plans.push_back(replay);
+	}
+
+	return true;
+}
+
+//Latency at fraction p of the sorted samples
+static double percentile(const vector<double>& sorted, double p) {
+	if (sorted.empty()) {
+		return 0;
+	}
+
+	return sorted[min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+int main(int argc, char** argv) {
+	vector<string> args(argv + 1, argv + argc);
+	vector<string> files;
+	UnixTime now = (UnixTime)time(nullptr);
+	int repeat = 1;
+	bool quiet = false;
+
+	for (size_t i = 0; i < args.size(); i++) {
+		if (args[i] == "--time" && i + 1 < args.size()) {
+			now = strtoll(args[++i].c_str(), nullptr, 10);
+		}
+		else if (args[i] == "--repeat" && i + 1 < args.size()) {
+			repeat = max(1, atoi(args[++i].c_str()));
+		}
+		else if (args[i] == "--quiet") {
+			quiet = true;
+		}
+		else {
+			files.push_back(args[i]);
+		}
+	}
+
+	if (files.size() != 2) {
+		cerr << "Usage: VFPCReplay <Sid.json|Sid.bin> <plans.ndjson> [--time <unix time>] [--repeat <n>] [--quiet]\n";
+		cerr << "Prints callsign, verdict and failed checks per plan, then throughput and per-plan latency.\n";
+		return 2;
+	}
+
+	std::shared_ptr<SidRuleset> rules = std::make_shared<SidRuleset>();
+	if (!loadRules(files[0], *rules)) {
+		return 1;
+	}
+
+	vector<ReplayPlan> plans;
+	if (!readPlans(files[1], plans)) {
+		return 1;
+	}
+
+	std::shared_ptr<const SidRuleset> ruleset = rules;
+	int minuteOfWeek = londonMinuteOfWeek(now);
+
+	vector<double> latencies;
+	latencies.reserve(plans.size() * repeat);
+	size_t passed = 0;
+	double total = 0;
+
+	for (int pass = 0; pass < repeat; pass++) {
+		for (const ReplayPlan& replay : plans) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			CheckResult result = checkFlightPlan(replay.plan, ruleset, minuteOfWeek);
+			double elapsed = millisSince(start);
+
+			latencies.push_back(elapsed);
+			total += elapsed;
+
+			//Verdicts are the same on every pass, only the first is printed
+			if (pass > 0) {
+				continue;
+			}
+
+			if (result.passed) {
+				passed++;
+			}
+
+			if (!quiet) {
+				vector<const char*> fails = result.passed ? vector<const char*>() : checkFails(result);
+				cout << replay.plan.callsign << "\t" << (result.passed ? "Passed" : "Failed") << "\t" << boost::join(vector<string>(fails.begin(), fails.end()), ",") << "\n";
+			}
+		}
+	}
+
+	sort(latencies.begin(), latencies.end());
+
+	cerr << boost::format("%i plans, %i passed, %i failed\n") % plans.size() % passed % (plans.size() - passed);
+	cerr << boost::format("%i checks in %.2f ms: %.0f plans/s, p50 %.2f us, p99 %.2f us\n") % latencies.size() % total
+		% (total > 0 ? latencies.size() * 1000.0 / total : 0.0) % (percentile(latencies, 0.5) * 1000) % (percentile(latencies, 0.99) * 1000);
+
+	return 0;
+}
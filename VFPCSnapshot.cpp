@@ -0,0 +1,301 @@
+//Converts SID data into ruleset snapshots, validates them and compares how long loading and holding each format takes
+//Usage: VFPCSnapshot convert <Sid.json> <Sid.bin>
+//       VFPCSnapshot validate <Sid.bin> [<Sid.json>]
+//       VFPCSnapshot bench <Sid.json> <Sid.bin> [--repeat <n>]
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <boost/format.hpp>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "Ruleset.hpp"
+#include "RulesetSnapshot.hpp"
+
+using namespace std;
+
+static bool readFile(const string& path, vector<char>& text) {
+	ifstream ifs(path.c_str(), ios::binary | ios::ate);
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	//Terminated for in-situ parsing
+	text.resize((size_t)ifs.tellg() + 1);
+	ifs.seekg(0);
+	ifs.read(&text[0], text.size() - 1);
+	text.back() = '\0';
+
+	return !ifs.fail();
+}
+
+static double millisSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+//Compiles SID data the same way the plugin does by default, with the streaming loader
+static bool compileFile(const string& path, SidRuleset& rules, bool report) {
+	vector<char> text;
+	if (!readFile(path, text)) {
+		cerr << path << ": Could not be read\n";
+		return false;
+	}
+
+	vector<RulesetIssue> issues;
+	bool parsed = compileRulesetStream(&text[0], rules, issues);
+
+	if (report) {
+		for (size_t i = 0; i < issues.size() && i < 10; i++) {
+			cerr << boost::format("%s: %s (Offset: %i)\n") % path % issues[i].message % issues[i].offset;
+		}
+		if (issues.size() > 10) {
+			cerr << boost::format("%s: %i further issues\n") % path % (issues.size() - 10);
+		}
+	}
+
+	return parsed;
+}
+
+//Encoding rules decoded from a snapshot must give back the snapshot of the rules they came from
+static bool sameRules(const SidRuleset& compiled, const SidRuleset& decoded, const RulesetSnapshotInfo& info) {
+	vector<char> expected;
+	vector<char> actual;
+	encodeRulesetSnapshot(compiled, info, expected);
+	encodeRulesetSnapshot(decoded, info, actual);
+
+	return expected == actual;
+}
+
+static int convert(const string& source, const string& target) {
+	SidRuleset rules;
+	if (!compileFile(source, rules, true)) {
+		return 1;
+	}
+
+	string error;
+	if (!writeRulesetSnapshot(target, rules, RulesetSnapshotInfo(), error)) {
+		cerr << target << ": " << error << "\n";
+		return 1;
+	}
+
+	SidRuleset loaded;
+	RulesetSnapshotInfo info;
+	size_t mapped = 0;
+	if (!loadRulesetSnapshot(target, loaded, info, mapped, error)) {
+		cerr << target << ": " << error << "\n";
+		return 1;
+	}
+
+	if (!sameRules(rules, loaded, info)) {
+		cerr << target << ": Does not decode to the rules it was written from\n";
+		return 1;
+	}
+
+	cout << boost::format("%s: %i airports, %i bytes, validated\n") % target % loaded.airports.size() % mapped;
+	return 0;
+}
+
+static int validate(const string& snapshot, const string& source) {
+	vector<char> data;
+	if (!readFile(snapshot, data)) {
+		cerr << snapshot << ": Could not be read\n";
+		return 1;
+	}
+
+	//readFile adds a terminator, which isn't part of the snapshot
+	size_t size = data.size() - 1;
+	string error;
+	if (!validateRulesetSnapshot(&data[0], size, error)) {
+		cerr << snapshot << ": " << error << "\n";
+		return 1;
+	}
+
+	SidRuleset decoded;
+	RulesetSnapshotInfo info;
+	if (!readRulesetSnapshot(&data[0], size, decoded, info, error)) {
+		cerr << snapshot << ": " << error << "\n";
+		return 1;
+	}
+
+	cout << boost::format("%s: %i airports, %i bytes, format version %i, valid\n") % snapshot % decoded.airports.size() % size % RulesetSnapshotVersion;
+	if (info.fetched != 0) {
+		cout << boost::format("%s: downloaded at %i, ETag %s, Last-Modified %s\n") % snapshot % info.fetched % info.etag % info.lastModified;
+	}
+
+	if (source.empty()) {
+		return 0;
+	}
+
+	SidRuleset compiled;
+	if (!compileFile(source, compiled, true)) {
+		return 1;
+	}
+
+	if (!sameRules(compiled, decoded, info)) {
+		cerr << boost::format("%s: Does not hold the rules compiled from %s\n") % snapshot % source;
+		return 1;
+	}
+
+	cout << boost::format("%s: matches %s\n") % snapshot % source;
+	return 0;
+}
+
+//Resident and peak resident memory of this process in bytes, from /proc/self/status
+static bool readMemory(size_t& resident, size_t& peak) {
+	ifstream status("/proc/self/status");
+	string line;
+	resident = peak = 0;
+
+	while (getline(status, line)) {
+		if (line.compare(0, 6, "VmRSS:") == 0) {
+			resident = strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+		}
+		else if (line.compare(0, 6, "VmHWM:") == 0) {
+			peak = strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+		}
+	}
+
+	return resident != 0 && peak != 0;
+}
+
+//One cold load: time taken, memory still resident once loaded and the most resident at any point, both above what was resident before
+struct LoadSample {
+	bool ok;
+	double ms;
+	size_t held;
+	size_t peak;
+};
+
+//Loads in a forked child, so every sample starts from a fresh heap with nothing left over from earlier loads
+static LoadSample sampleLoad(const string& path, bool snapshot) {
+	LoadSample sample = LoadSample();
+	int channel[2];
+	if (pipe(channel) != 0) {
+		return sample;
+	}
+
+	pid_t child = fork();
+	if (child == 0) {
+		close(channel[0]);
+
+		//Restart the peak from the current resident size, where the kernel allows it
+		{
+			ofstream clear("/proc/self/clear_refs");
+			clear << "5";
+		}
+
+		size_t before = 0;
+		size_t peakBefore = 0;
+		readMemory(before, peakBefore);
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		SidRuleset rules;
+		RulesetSnapshotInfo info;
+		size_t mapped = 0;
+		string error;
+		sample.ok = snapshot ? loadRulesetSnapshot(path, rules, info, mapped, error) : compileFile(path, rules, false);
+		sample.ms = millisSince(start);
+
+		size_t after = 0;
+		size_t peak = 0;
+		sample.ok = readMemory(after, peak) && sample.ok;
+		sample.held = after > before ? after - before : 0;
+		//If the peak couldn't be restarted and the load stayed below it, only what the load holds is known
+		sample.peak = peak > max(before, peakBefore) ? peak - before : sample.held;
+
+		ssize_t written = write(channel[1], &sample, sizeof(sample));
+		_exit(written == sizeof(sample) ? 0 : 1);
+	}
+
+	close(channel[1]);
+	if (child > 0) {
+		if (read(channel[0], &sample, sizeof(sample)) != sizeof(sample)) {
+			sample.ok = false;
+		}
+		waitpid(child, nullptr, 0);
+	}
+	close(channel[0]);
+
+	return sample;
+}
+
+static double median(vector<double> values) {
+	sort(values.begin(), values.end());
+	return values.empty() ? 0 : values[values.size() / 2];
+}
+
+static int bench(const string& source, const string& snapshot, int repeat) {
+	ifstream jsonFile(source.c_str(), ios::binary | ios::ate);
+	ifstream snapshotFile(snapshot.c_str(), ios::binary | ios::ate);
+	if (!jsonFile.is_open() || !snapshotFile.is_open()) {
+		cerr << (jsonFile.is_open() ? snapshot : source) << ": Could not be read\n";
+		return 1;
+	}
+	size_t sizes[2] = { (size_t)jsonFile.tellg(), (size_t)snapshotFile.tellg() };
+	const string* paths[2] = { &source, &snapshot };
+
+	cout << boost::format("%i cold loads of each in a fresh process, files already in the page cache. Medians:\n") % repeat;
+
+	for (int format = 0; format < 2; format++) {
+		vector<double> times;
+		vector<double> held;
+		vector<double> peaks;
+
+		for (int i = 0; i < repeat; i++) {
+			LoadSample sample = sampleLoad(*paths[format], format == 1);
+			if (!sample.ok) {
+				cerr << *paths[format] << ": Could not be loaded\n";
+				return 1;
+			}
+
+			times.push_back(sample.ms);
+			held.push_back((double)sample.held);
+			peaks.push_back((double)sample.peak);
+		}
+
+		cout << boost::format("%s: %i bytes, %.2f ms to %s, %.0f bytes resident once loaded, %.0f bytes at peak\n") % *paths[format] % sizes[format] % median(times)
+			% (format == 1 ? "map, validate and decode" : "read, parse and compile") % median(held) % median(peaks);
+	}
+
+	//Snapshot loads decode into the same heap structures as compiling, then unmap the file
+	cout << "Both formats end as a decoded ruleset on the heap. The snapshot is mapped only while it is validated and copied out, so its peak includes the mapped file.\n";
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	vector<string> args(argv + 1, argv + argc);
+	vector<string> files;
+	int repeat = 9;
+
+	for (size_t i = 1; i < args.size(); i++) {
+		if (args[i] == "--repeat" && i + 1 < args.size()) {
+			repeat = max(1, atoi(args[++i].c_str()));
+		}
+		else {
+			files.push_back(args[i]);
+		}
+	}
+
+	string mode = args.empty() ? "" : args[0];
+
+	if (mode == "convert" && files.size() == 2) {
+		return convert(files[0], files[1]);
+	}
+	else if (mode == "validate" && (files.size() == 1 || files.size() == 2)) {
+		return validate(files[0], files.size() == 2 ? files[1] : "");
+	}
+	else if (mode == "bench" && files.size() == 2) {
+		return bench(files[0], files[1], repeat);
+	}
+
+	cerr << "Usage: VFPCSnapshot convert <Sid.json> <Sid.bin>\n";
+	cerr << "       VFPCSnapshot validate <Sid.bin> [<Sid.json>]\n";
+	cerr << "       VFPCSnapshot bench <Sid.json> <Sid.bin> [--repeat <n>]\n";
+	cerr << "convert writes a snapshot of the compiled rules, validate checks one (and that it matches the JSON, if given),\n";
+	cerr << "bench times cold loads of both and measures the memory they hold.\n";
+	return 2;
+}
@@ -1,13 +1,12 @@
 #include "stdafx.h"
 #include "analyzeFP.hpp"
-#include <curl/curl.h>
 #include <future>
+#include <ctime>
+#include <chrono>
 
 extern "C" IMAGE_DOS_HEADER __ImageBase;
 
-bool blink, debugMode, validVersion, autoLoad, fileLoad;
-
-vector<int> timedata;
+bool blink, debugMode, validVersion, autoLoad, fileLoad, streamLoad;
 
 size_t failPos;
 int relCount;
@@ -25,11 +24,34 @@ CVFPCPlugin::CVFPCPlugin(void) :CPlugIn(EuroScopePlugIn::COMPATIBILITY_CODE, MY_
 	validVersion = true; //Reset in first timer call
 	autoLoad = true;
 	fileLoad = false;
+	streamLoad = true;
 
 	failPos = 0;
 	relCount = 0;
-
-	timedata = { 0, 0, 0 };
+	rulesGeneration = 0;
+	dropValidators = false;
+	refetchSids = false;
+	parseBlockSize = 64 * 1024;
+	configFetched = 0;
+	publishedRules = std::make_shared<const SidRuleset>();
+	stopWorker = false;
+	checkResultsReady = false;
+
+	//Start with the last downloaded data until a fresh copy arrives, from the snapshot of its compiled rules if it can be used
+	{
+		std::shared_ptr<SidRuleset> snapshot = std::make_shared<SidRuleset>();
+		if (snapshotCall(*snapshot)) {
+			publishRules(snapshot);
+		}
+		else {
+			SidData cached(getParseBlock(), streamLoad);
+			if (cacheCall(cached)) {
+				publishRules(cached.rules);
+				saveSnapshot(*cached.rules);
+				finishLoad(cached);
+			}
+		}
+	}
 
 	string loadingMessage = "Loading complete. Version: ";
 	loadingMessage += MY_PLUGIN_VERSION;
@@ -41,19 +63,28 @@ CVFPCPlugin::CVFPCPlugin(void) :CPlugIn(EuroScopePlugIn::COMPATIBILITY_CODE, MY_
 		RegisterTagItemType("VFPC", TAG_ITEM_FPCHECK);
 		RegisterTagItemFunction("Show Checks", TAG_FUNC_CHECKFP_MENU);
 	}
+
+	// Flight plan checks run off the EuroScope thread
+	checkWorker = thread(&CVFPCPlugin::runCheckWorker, this);
 }
 
 //Run on Plugin Destruction (Closing EuroScope or unloading plugin)
 CVFPCPlugin::~CVFPCPlugin()
 {
-}
+	{
+		lock_guard<mutex> lock(checkMutex);
+		stopWorker = true;
+	}
+	checkSignal.notify_all();
 
-//Stores output of HTTP request in string
-static size_t curlCallback(void *contents, size_t size, size_t nmemb, void *outString)
-{
-	// For Curl, we should assume that the data is not null terminated, so add a null terminator on the end
- 	((std::string*)outString)->append(reinterpret_cast<char*>(contents), size * nmemb);
-	return size * nmemb;
+	if (checkWorker.joinable()) {
+		checkWorker.join();
+	}
+
+	// Web calls use the HTTP client and rules, let them finish first
+	if (fut.valid()) {
+		fut.wait();
+	}
 }
 
 //Send message to user via "VFPC Log" channel
@@ -75,95 +106,144 @@ void CVFPCPlugin::sendMessage(string message) {
 	DisplayUserMessage("VFPC", "System", message.c_str(), true, true, true, false, false);
 }
 
-//CURL call, saves output to passed string reference
-bool CVFPCPlugin::webCall(string url, string& out) {
-	CURL* curl = curl_easy_init();
-	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+//Builds a GET request. If validators are passed, the request is conditional.
+HttpRequest CVFPCPlugin::webRequest(string url, HttpValidators* validators) {
+	HttpRequest request;
+	request.url = url;
 
-	uint64_t httpCode = 0;
+	if (validators != nullptr) {
+		if (validators->etag.size()) {
+			request.headers.push_back("If-None-Match: " + validators->etag);
+		}
+		if (validators->lastModified.size()) {
+			request.headers.push_back("If-Modified-Since: " + validators->lastModified);
+		}
+	}
+
+	return request;
+}
+
+//Builds the mongoFull request, conditional on the stored validators unless a command dropped them. Caller holds loadMutex.
+HttpRequest CVFPCPlugin::sidRequest() {
+	if (dropValidators.exchange(false)) {
+		configValidators = HttpValidators();
+	}
+
+	return webRequest(MY_API_ADDRESS "mongoFull", &configValidators);
+}
 
-	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out);
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curlCallback);
+//Checks a completed request and logs its timing
+//For a conditional request, a 304 response sets validators->notModified and leaves the body empty
+bool CVFPCPlugin::webResult(HttpRequest& request, HttpValidators* validators) {
+	const HttpTiming& timing = request.timing;
 
-	curl_easy_perform(curl);
-	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-	curl_easy_cleanup(curl);
+	debugMessage("HTTP", str(boost::format("%s: %i in %.1f ms (DNS %.1f, connect %.1f, TLS %.1f, first byte %.1f)%s") % request.url % request.status % timing.total
+		% timing.nameLookup % timing.connect % timing.tls % timing.firstByte % (timing.reused ? ", reused connection" : "")));
 
-	if (httpCode == 200) {
+	//Body size on the wire against decoded size. Decoding is done by curl as data arrives, so it is part of the body time.
+	if (request.encoding.size()) {
+		debugMessage("HTTP", str(boost::format("%s: %u bytes %s, %u bytes decoded (%.1f%%), body %.1f ms") % request.url % request.transferred % request.encoding
+			% request.body.size() % (request.body.size() ? 100.0 * request.transferred / request.body.size() : 100.0) % (timing.total - timing.firstByte)));
+	}
+	else if (request.body.size()) {
+		debugMessage("HTTP", str(boost::format("%s: %u bytes uncompressed, body %.1f ms") % request.url % request.body.size() % (timing.total - timing.firstByte)));
+	}
+
+	if (request.status == 200) {
+		if (validators != nullptr) {
+			validators->etag = request.received.etag;
+			validators->lastModified = request.received.lastModified;
+			validators->notModified = false;
+		}
+		return true;
+	}
+	else if (request.status == 304 && validators != nullptr) {
+		validators->notModified = true;
 		return true;
 	}
 	
 	return false;
 }
 
-//Makes CURL call to Date/Time server and stores output
-bool CVFPCPlugin::timeCall() {
+//Compares completed call to Date/Time server with the locally computed time, only made in debug mode
+bool CVFPCPlugin::timeCall(HttpRequest& request) {
 	Document doc;
-	string url = "http://worldtimeapi.org/api/timezone/Europe/London";
-	string buf = "";
 
-	if (webCall(url, buf))
+	if (webResult(request))
 	{
-		if (doc.Parse<0>(buf.c_str()).HasParseError())
+		if (!parseJson(doc, request.body, request.url))
 		{
-			sendMessage("An error occurred whilst reading date/time data. The plugin will not automatically attempt to reload from the API. To restart data fetching, type \".vfpc load\".");
-			debugMessage("Error", str(boost::format("Config Parse: %s (Offset: %i)\n'") % config.GetParseError() % config.GetErrorOffset()));
+			debugMessage("Error", str(boost::format("Time Parse: %s (Offset: %i)\n'") % doc.GetParseError() % doc.GetErrorOffset()));
 		}
 		else if (doc.HasMember("datetime") && doc["datetime"].IsString() && doc.HasMember("day_of_week") && doc["day_of_week"].IsInt()) {
 			string hour = ((string)doc["datetime"].GetString()).substr(11, 2);
 			string mins = ((string)doc["datetime"].GetString()).substr(14, 2);
 
-			timedata[0] = doc["day_of_week"].GetInt();
-			timedata[1] = stoi(hour);
-			timedata[2] = stoi(mins);
+			int remote = (doc["day_of_week"].GetInt() * 24 + stoi(hour)) * 60 + stoi(mins);
+			int drift = (remote - getTimeKey() + MinutesPerWeek) % MinutesPerWeek;
+			if (drift > MinutesPerWeek / 2) {
+				drift -= MinutesPerWeek;
+			}
+
+			//A minute either way is the clocks ticking over between the two readings
+			if (abs(drift) > 1) {
+				debugMessage("Warning", str(boost::format("System clock differs from time server by %i minutes. Restrictions are checked against the system clock.") % drift));
+			}
+			else {
+				debugMessage("Info", "System clock agrees with time server.");
+			}
 
 			return true;
 		}
 	}
 	else
 	{
-		sendMessage("An error occurred whilst downloading date/time data. The plugin will not automatically attempt to reload from the API. Check your connection and restart data fetching by typing \".vfpc load\".");
-		debugMessage("Error", str(boost::format("Config Download: %s (Offset: %i)\n'") % config.GetParseError() % config.GetErrorOffset()));
+		debugMessage("Warning", "Time server could not be reached to check the system clock.");
 	}
 
 	return false;
 }
 
-//Makes CURL call to API server for data and stores output
-bool CVFPCPlugin::APICall(string endpoint, Document& out) {
-	string url = MY_API_ADDRESS + endpoint;
-	string buf = "";
-
-	if (webCall(url, buf))
+//Compiles output of completed call to API server
+bool CVFPCPlugin::APICall(HttpRequest& request, SidData& data, HttpValidators* validators) {
+	if (webResult(request, validators))
 	{
-		if (out.Parse<0>(buf.c_str()).HasParseError())
+		//Unchanged since the last download - the published rules still hold that data
+		if (validators != nullptr && validators->notModified) {
+			return true;
+		}
+
+		//Parsed in-situ, so request.body must outlive data
+		if (!parseSids(data, &request.body[0], request.body.size(), request.url))
 		{
+			if (validators != nullptr) {
+				*validators = HttpValidators();
+			}
+
+
 			sendMessage("An error occurred whilst reading data. The plugin will not automatically attempt to reload from the API. To restart data fetching, type \".vfpc load\".");
-			debugMessage("Error", str(boost::format("Config Parse: %s (Offset: %i)\n'") % config.GetParseError() % config.GetErrorOffset()));
+			debugMessage("Error", str(boost::format("Config Parse: %s (Offset: %i)\n'") % data.error % data.errorOffset));
 			return false;
-
-			out.Parse<0>("[]");
 		}
 	}
 	else
 	{
 		sendMessage("An error occurred whilst downloading data. The plugin will not automatically attempt to reload from the API. Check your connection and restart data fetching by typing \".vfpc load\".");
-		debugMessage("Error", str(boost::format("Config Download: %s (Offset: %i)\n'") % config.GetParseError() % config.GetErrorOffset()));
+		debugMessage("Error", str(boost::format("Config Download: %s (Offset: %i)\n'") % data.error % data.errorOffset));
 		return false;
-
-		out.Parse<0>("[]");
 	}
 
 	return true;
 }
 
-//Makes CURL call to API server for current version and stores output
-bool CVFPCPlugin::versionCall() {
+//Checks completed call to API server for current version
+bool CVFPCPlugin::versionCall(HttpRequest& request) {
 	Document version;
-	APICall("version", version);
-	
-	if (version.HasMember("VFPC_Version") && version["VFPC_Version"].IsString()) {
+	if (webResult(request)) {
+		parseJson(version, request.body, request.url);
+	}
+
+	if (version.IsObject() && version.HasMember("VFPC_Version") && version["VFPC_Version"].IsString()) {
 		vector<string> current = split(version["VFPC_Version"].GetString(), '.');
 		vector<string> installed = split(MY_PLUGIN_VERSION, '.');
 
@@ -183,871 +263,591 @@ bool CVFPCPlugin::versionCall() {
 	return false;
 }
 
-//Loads data from file
-bool CVFPCPlugin::fileCall(Document &out) {
+//Path of a file in the plugin's directory
+string CVFPCPlugin::pluginFile(string name) {
 	char DllPathFile[_MAX_PATH];
 	GetModuleFileNameA(HINSTANCE(&__ImageBase), DllPathFile, sizeof(DllPathFile));
 	string pfad = DllPathFile;
 	pfad.resize(pfad.size() - strlen("VFPC.dll"));
-	pfad += "Sid.json";
+	pfad += name;
 
-	stringstream ss;
-	ifstream ifs;
-	ifs.open(pfad.c_str(), ios::binary);
+	return pfad;
+}
 
-	if (ifs.is_open()) {
-		ss << ifs.rdbuf();
-		ifs.close();
+//Formats a download time for messages
+static string fetchedText(time_t fetched) {
+	char text[32] = "unknown date";
+	tm fetchedTime;
+	if (fetched && gmtime_s(&fetchedTime, &fetched) == 0) {
+		strftime(text, sizeof(text), "%Y-%m-%d %H:%MZ", &fetchedTime);
+	}
 
-		if (out.Parse<0>(ss.str().c_str()).HasParseError()) {
-			sendMessage("An error occurred whilst reading data. The plugin will not automatically attempt to reload. To restart data fetching from the API, type \".vfpc load\". To reattempt loading data from the Sid.json file, type \".vfpc file\".");
-			debugMessage("Error", str(boost::format("Config Parse: %s (Offset: %i)\n'") % out.GetParseError() % out.GetErrorOffset()));
+	return text;
+}
+
+//Reads a whole file into text
+static bool readFile(const string& path, string& text) {
+	ifstream ifs(path.c_str(), ios::binary | ios::ate);
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	text.resize((size_t)ifs.tellg());
+	ifs.seekg(0);
+	ifs.read(&text[0], text.size());
+
+	return !ifs.fail();
+}
+
+//Parses text in-situ into out and logs parse time and allocator use. Strings in out point into text afterwards.
+bool CVFPCPlugin::parseJson(Document& out, string& text, const string& source) {
+	return parseJson(out, &text[0], text.size(), source);
+}
+
+bool CVFPCPlugin::parseJson(Document& out, char* text, size_t length, const string& source) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	out.ParseInsitu<0>(text);
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	debugMessage("Info", str(boost::format("%s: parsed %u bytes in %.2f ms, %u bytes allocated") % source % length % ms % out.GetAllocator().Capacity()));
+
+	return !out.HasParseError();
+}
 
-			out.Parse<0>("[]");
+//Compiles SID data text into data.rules with the selected loader and logs how long it took. text is parsed in-situ.
+//The DOM loader parses into data.doc first, the streaming loader compiles in a single pass and reports schema problems with their offsets.
+bool CVFPCPlugin::parseSids(SidData& data, char* text, size_t length, const string& source) {
+	data.source = source;
+	data.length = length;
+	chrono::steady_clock::time_point loadStart = chrono::steady_clock::now();
+
+	if (!data.stream) {
+		if (!parseJson(data.doc, text, length, source)) {
+			data.error = data.doc.GetParseError();
+			data.errorOffset = data.doc.GetErrorOffset();
 			return false;
 		}
 
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		compileRuleset(data.doc, *data.rules);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		data.parseMs = chrono::duration<double, milli>(chrono::steady_clock::now() - loadStart).count();
+
+		debugMessage("Info", str(boost::format("%s: compiled %u airports from DOM in %.2f ms") % source % data.rules->airports.size() % ms));
 		return true;
 	}
-	else {
-		sendMessage("Sid.json file not found. The plugin will not automatically attempt to reload. To restart data fetching from the API, type \".vfpc load\". To reattempt loading data from the Sid.json file, type \".vfpc file\".");
-		debugMessage("Error", "Sid.json file not found.");
 
-		out.Parse<0>("[]");
-		return false;
+	vector<RulesetIssue> issues;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	bool parsed = compileRulesetStream(text, *data.rules, issues);
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	data.parseMs = ms;
+
+	if (!parsed) {
+		data.error = issues.back().message;
+		data.errorOffset = issues.back().offset;
+		data.rules = std::make_shared<SidRuleset>();
+		issues.pop_back();
 	}
-}
 
-//Loads data and sorts into airports
-void CVFPCPlugin::getSids() {
-	//Load data from API
-	if (autoLoad) {
-		autoLoad = APICall("mongoFull", config);
+	debugMessage("Info", str(boost::format("%s: streamed %u bytes into %u airports in %.2f ms") % source % length % data.rules->airports.size() % ms));
+
+	//Skipped as the DOM loader would, only the first few are shown
+	for (size_t i = 0; i < issues.size() && i < 10; i++) {
+		debugMessage("Warning", str(boost::format("%s: %s (Offset: %u)") % source % issues[i].message % issues[i].offset));
 	}
-	//Load data from Sid.json file
-	else if (fileLoad) {
-		fileLoad = fileCall(config);
+	if (issues.size() > 10) {
+		debugMessage("Warning", str(boost::format("%s: %u further entries did not match the schema.") % source % (issues.size() - 10)));
 	}
 
-	//Sort new data into airports
-	airports.clear();
-	for (SizeType i = 0; i < config.Size(); i++) {
-		const Value& airport = config[i];
-		if (airport.HasMember("icao") && airport["icao"].IsString()) {
-			string airport_icao = airport["icao"].GetString();
-			airports.insert(pair<string, SizeType>(airport_icao, i));
-		}
-	}
+	return parsed;
 }
 
-//Checks flight plan
-vector<vector<string>> CVFPCPlugin::validizeSid(CFlightPlan flightPlan) {
-	//out[0] = Normal Output, out[1] = Debug Output
-	vector<vector<string>> returnOut = { vector<string>(), vector<string>() }; // 0 = Callsign, 1 = SID, 2 = Destination, 3 = Route, 4 = Nav Performance, 5 = Min/Max Flight Level, 6 = Even/Odd, 7 = Suffix, 8 = Aircraft Type, 9 = Date/Time, 10 = Syntax, 11 = Passed/Failed
+//Loads last downloaded API data and its validators from the cache file into data
+//The file starts with "ETag", "Last-Modified" and "Fetched" (Unix time) header lines, followed by an empty line and the data as downloaded
+bool CVFPCPlugin::cacheCall(SidData& data) {
+	string path = pluginFile("SidCache.json");
+	if (!readFile(path, data.text)) {
+		return false;
+	}
 
-	returnOut[0].push_back(flightPlan.GetCallsign());
-	returnOut[1].push_back(flightPlan.GetCallsign());
-	for (int i = 1; i < 11; i++) {
-		returnOut[0].push_back("-");
-		returnOut[1].push_back("-");
+	HttpValidators validators;
+	time_t fetched = 0;
+	size_t pos = 0;
+
+	while (pos < data.text.size()) {
+		size_t end = data.text.find('\n', pos);
+		if (end == string::npos) {
+			return false;
+		}
+
+		string line = data.text.substr(pos, end - pos);
+		pos = end + 1;
+
+		if (line.empty()) {
+			break;
+		}
+
+		size_t colon = line.find(':');
+		if (colon == string::npos) {
+			continue;
+		}
+
+		string value = boost::trim_copy(line.substr(colon + 1));
+		if (startsWith("ETag:", line.c_str())) {
+			validators.etag = value;
+		}
+		else if (startsWith("Last-Modified:", line.c_str())) {
+			validators.lastModified = value;
+		}
+		else if (startsWith("Fetched:", line.c_str())) {
+			fetched = (time_t)atoll(value.c_str());
+		}
 	}
 
-	string origin = flightPlan.GetFlightPlanData().GetOrigin(); boost::to_upper(origin);
-	string destination = flightPlan.GetFlightPlanData().GetDestination(); boost::to_upper(destination);
-	SizeType origin_int;
+	if (!parseSids(data, &data.text[pos], data.text.size() - pos, path) || data.rules->airports.empty()) {
+		return false;
+	}
 
-	// Airport defined
-	if (airports.find(origin) == airports.end()) {
-		returnOut[0][1] = "Invalid SID - Airport Not Found";
-		returnOut[0].back() = "Failed";
+	configValidators = validators;
+	configFetched = fetched;
 
-		returnOut[1][1] = "Invalid SID - " + origin + " not in database.";
-		returnOut[1].back() = "Failed";
-		return returnOut;
+	sendMessage("Using cached data from " + fetchedText(fetched) + " until the latest data has been downloaded.");
+
+	return true;
+}
+
+//Writes freshly downloaded API data to a temporary cache file, which commitCache then moves into place
+//Written before parsing, as in-situ parsing overwrites the downloaded text
+bool CVFPCPlugin::saveCache(const HttpRequest& request) {
+	string temp = pluginFile("SidCache.json.tmp");
+
+	ofstream ofs(temp.c_str(), ios::binary | ios::trunc);
+	if (!ofs.is_open()) {
+		debugMessage("Warning", "Could not write SID cache file.");
+		return false;
 	}
-	else
-	{
-		origin_int = airports[origin];
+
+	ofs << "ETag: " << request.received.etag << "\n";
+	ofs << "Last-Modified: " << request.received.lastModified << "\n";
+	ofs << "Fetched: " << (long long)time(nullptr) << "\n";
+	ofs << "\n";
+	ofs << request.body;
+	ofs.close();
+
+	if (!ofs) {
+		debugMessage("Warning", "Could not write SID cache file.");
+		return false;
 	}
 
-	int RFL = flightPlan.GetFlightPlanData().GetFinalAltitude();
+	return true;
+}
+
+//Replaces the cache file with the one written by saveCache, once its data has parsed
+//Written to a temporary file first so a crash or bad download can't replace a good cache
+void CVFPCPlugin::commitCache() {
+	string path = pluginFile("SidCache.json");
+	string temp = path + ".tmp";
 
-	vector<string> route = split(flightPlan.GetFlightPlanData().GetRoute(), ' ');
-	for (size_t i = 0; i < route.size(); i++) {
-		boost::to_upper(route[i]);
+	if (!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		debugMessage("Warning", "Could not write SID cache file.");
 	}
+}
 
-	vector<string> points{};
-	CFlightPlanExtractedRoute extracted = flightPlan.GetExtractedRoute();
-	for (int i = 0; i < extracted.GetPointsNumber(); i++) {
-		points.push_back(extracted.GetPointName(i));
+//Loads the compiled rules of the last downloaded API data and their validators from the snapshot file, which is mapped rather than parsed
+bool CVFPCPlugin::snapshotCall(SidRuleset& out) {
+	string path = pluginFile("SidCache.bin");
+	RulesetSnapshotInfo info;
+	size_t mapped = 0;
+	string error;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	if (!loadRulesetSnapshot(path, out, info, mapped, error)) {
+		debugMessage("Info", "SID snapshot not used: " + error);
+		return false;
 	}
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 
-	// Remove Speed/Alt Data From Route
-	regex lvl_chng("(N|M|K)[0-9]{3,4}(A|F)[0-9]{3}$");
+	debugMessage("Info", str(boost::format("%s: mapped %u bytes into %u airports in %.2f ms") % path % mapped % out.airports.size() % ms));
 
-	// Remove "DCT" And Speed/Level Change Instances from Route
-	for (size_t i = 0; i < route.size(); i++) {
-		int count = 0;
-		size_t pos = 0;
+	configValidators = HttpValidators();
+	configValidators.etag = info.etag;
+	configValidators.lastModified = info.lastModified;
+	configFetched = (time_t)info.fetched;
 
-		for (size_t j = 0; j < route[i].size(); j++) {
-			if (route[i][j] == '/') {
-				count++;
-				pos = j;
-			}
-		}
+	sendMessage("Using cached data from " + fetchedText(configFetched) + " until the latest data has been downloaded.");
 
-		switch (count) {
-			case 0:
-			{
-				break;
-			}
-			case 2:
-			{
-				size_t first_pos = route[i].find('/');
-				route[i] = route[i].substr(first_pos, string::npos);
-			}
-			case 1:
-			{
-				if (route[i].size() > pos + 1 && regex_match((route[i].substr(pos + 1, string::npos)), lvl_chng)) {
-					route[i] = route[i].substr(0, pos);
-					break;
-				}
-				else {
-					returnOut[0][returnOut[0].size() - 2] = "Invalid Speed/Level Change";
-					returnOut[0].back() = "Failed";
+	return true;
+}
 
-					returnOut[1][returnOut[1].size() - 2] = "Invalid Route Item: " + route[i];
-					returnOut[1].back() = "Failed";
-					return returnOut;
-				}
-			}
-			default:
-			{
-				returnOut[0][returnOut.size() - 2] = "Invalid Syntax - Too Many \"/\" Characters in One or More Waypoints";
-				returnOut[0].back() = "Failed";
-
-				returnOut[1][returnOut.size() - 2] = "Invalid Route Item: " + route[i];
-				returnOut[1].back() = "Failed";
-				return returnOut;
-			}
-		}
+//Writes the compiled rules of the cached API data to the snapshot file, so the next start needs no parsing
+void CVFPCPlugin::saveSnapshot(const SidRuleset& rules) {
+	string path = pluginFile("SidCache.bin");
+	RulesetSnapshotInfo info;
+	info.etag = configValidators.etag;
+	info.lastModified = configValidators.lastModified;
+	info.fetched = configFetched;
+	string error;
+
+	if (!writeRulesetSnapshot(path, rules, info, error)) {
+		//Otherwise the next start would prefer the older data in it over the cache file
+		remove(path.c_str());
+		debugMessage("Warning", "Could not write SID snapshot: " + error);
 	}
-	for (size_t i = 0; i < route.size(); i++) {
-		if (route[i] == "DCT") {
-			route.erase(route.begin() + i);
-		}
+}
+
+//Converts Sid.json into a snapshot file (Sid.bin), checks it decodes to the same rules and compares how long loading each takes
+void CVFPCPlugin::convertSnapshot() {
+	lock_guard<mutex> lock(loadMutex);
+	string source = pluginFile("Sid.json");
+	string target = pluginFile("Sid.bin");
+	SidData data(getParseBlock(), streamLoad);
+
+	//Same steps as fileCall
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	if (!readFile(source, data.text) || !parseSids(data, &data.text[0], data.text.size(), source)) {
+		sendMessage("Sid.json could not be read - no snapshot written.");
+		return;
 	}
+	double jsonMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	size_t jsonBytes = data.text.size() + data.pool.Size();
 
-	//Remove Speed/Level Data From Start Of Route
-	if (route.size() > 0 && regex_match(route[0], lvl_chng)) {
-		route.erase(route.begin());
+	string error;
+	if (!writeRulesetSnapshot(target, *data.rules, RulesetSnapshotInfo(), error)) {
+		sendMessage("Sid.bin could not be written: " + error);
+		return;
 	}
 
-	string sid = flightPlan.GetFlightPlanData().GetSidName(); boost::to_upper(sid);
+	SidRuleset loaded;
+	RulesetSnapshotInfo info;
+	size_t mapped = 0;
 
-	// Remove any # characters from SID name
-	boost::erase_all(sid, "#");
+	start = chrono::steady_clock::now();
+	if (!loadRulesetSnapshot(target, loaded, info, mapped, error)) {
+		sendMessage("Sid.bin failed validation: " + error);
+		return;
+	}
+	double snapshotMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 
-	// Flightplan has SID
-	if (!sid.length()) {
-		returnOut[0][1] = returnOut[1][1] = "Invalid SID - None Set";
-		returnOut[0].back() = returnOut[1].back() = "Failed";
-		return returnOut;
+	//Encoding the decoded rules again must give back the same file
+	vector<char> written;
+	vector<char> decoded;
+	encodeRulesetSnapshot(*data.rules, RulesetSnapshotInfo(), written);
+	encodeRulesetSnapshot(loaded, info, decoded);
+	if (written != decoded) {
+		sendMessage("Sid.bin does not decode to the rules it was written from.");
+		return;
 	}
 
-	string first_wp;
-	string sid_suffix;
-	if (origin == "EGLL" && sid == "CHK") {
-		first_wp = "CPT";
-		sid_suffix = "CHK";
+	sendMessage(str(boost::format("Sid.json converted to Sid.bin (%u airports, %u bytes) and validated.") % loaded.airports.size() % mapped));
+	sendMessage(str(boost::format("Sid.json: %.2f ms to read, parse and compile, %u bytes held besides the rules. Sid.bin: %.2f ms to map, validate and decode, %u bytes mapped while decoding. Both are decoded into the same rules in memory.")
+		% jsonMs % jsonBytes % snapshotMs % mapped));
+}
+
+//Loads data from file
+bool CVFPCPlugin::fileCall(SidData& data) {
+	string pfad = pluginFile("Sid.json");
+
+	if (readFile(pfad, data.text)) {
+		if (!parseSids(data, &data.text[0], data.text.size(), pfad)) {
+			sendMessage("An error occurred whilst reading data. The plugin will not automatically attempt to reload. To restart data fetching from the API, type \".vfpc load\". To reattempt loading data from the Sid.json file, type \".vfpc file\".");
+			debugMessage("Error", str(boost::format("Config Parse: %s (Offset: %i)\n'") % data.error % data.errorOffset));
+			return false;
+		}
+
+		return true;
 	}
 	else {
-		first_wp = sid.substr(0, sid.find_first_of("0123456789"));
-		if (0 != first_wp.length())
-			boost::to_upper(first_wp);
-		
-		if (first_wp.length() != sid.length()) {
-			sid_suffix = sid.substr(sid.find_first_of("0123456789"), sid.length());
-			boost::to_upper(sid_suffix);
-		}
+		sendMessage("Sid.json file not found. The plugin will not automatically attempt to reload. To restart data fetching from the API, type \".vfpc load\". To reattempt loading data from the Sid.json file, type \".vfpc file\".");
+		debugMessage("Error", "Sid.json file not found.");
+		return false;
 	}
+}
 
-	// Did not find a valid SID
-	if (0 == sid_suffix.length() && "VCT" != first_wp) {
-		returnOut[0][1] = returnOut[1][1] = "Invalid SID - None Set";
-		returnOut[0].back() = returnOut[1].back() = "Failed";
-		return returnOut;
-	}
+//Loads data and sorts into airports, from request if the API data has already been fetched
+void CVFPCPlugin::getSids(HttpRequest* request) {
+	lock_guard<mutex> lock(loadMutex);
+	SidData data(getParseBlock(), streamLoad);
+	bool snapshot = false;
 
-	// Check First Waypoint Correct. Remove SID References & First Waypoint From Route.
-	bool success = false;
-	bool stop = false;
+	//Load data from API
+	if (autoLoad) {
+		//A request built before the validators were dropped may be conditional on data no longer held, a 304 to it is fetched again in full.
+		//This runs inside the batch's callback, where http can't start another request, so runWebCalls does it afterwards.
+		if (dropValidators.exchange(false)) {
+			configValidators = HttpValidators();
 
-	while (!stop && route.size() > 0) {
-		size_t wp_size = first_wp.size();
-		size_t entry_size = route[0].size();
-		if (route[0].substr(0, wp_size) == first_wp) {
-			//First Waypoint
-			if (wp_size == entry_size) {
-				success = true;
-				stop = true;
-			}
-			//3 or 5 Letter Waypoint SID - In Full
-			else if (entry_size > wp_size && isdigit(route[0][wp_size])) {
-				//SID Has Letter Suffix
-				for (size_t i = wp_size + 1; i < entry_size; i++) {
-					if (!isalpha(route[0][i])) {
-						stop = true;
-					}
-				}
-			}
-			else {
-				stop = true;
+			if (request != nullptr && request->status == 304) {
+				refetchSids = true;
+				return;
 			}
+		}
 
-			route.erase(route.begin());
+		HttpRequest fetched;
+		if (request == nullptr) {
+			fetched = sidRequest();
+			http.get(fetched);
+			request = &fetched;
 		}
-		//5 Letter Waypoint SID - Abbreviated to 6 Chars
-		else if (wp_size == 5 && entry_size >= wp_size && isdigit(route[0][wp_size - 1])) {
-			//SID Has Letter Suffix
-			for (size_t i = wp_size; i < entry_size; i++) {
-				if (!isalpha(route[0][i])) {
-					stop = true;
-				}
-			}
 
-			route.erase(route.begin());
+		//Parsing overwrites the body, so it's written out first and only kept if it parses
+		bool cached = request->status == 200 && saveCache(*request);
+
+		autoLoad = APICall(*request, data, &configValidators);
+
+		//Download failed or database unchanged - keep the compiled rules
+		if (!autoLoad || configValidators.notModified) {
+			return;
 		}
-		else {
-			stop = true;
+
+		if (cached) {
+			commitCache();
+			configFetched = time(nullptr);
+			snapshot = true;
 		}
 	}
-	
-	if (!success) {
-		returnOut[0][1] = "Invalid SID - Route Not From Final SID Fix";
-		returnOut[0].back() = "Failed";
-
-		returnOut[1][1] = "Invalid SID - Route must start at " + first_wp + ".";
-		returnOut[1].back() = "Failed";
-		return returnOut;
+	//Load data from Sid.json file
+	else if (fileLoad) {
+		fileLoad = fileCall(data);
+	}
+	else {
+		return;
 	}
 
-	// Any SIDs defined
-	if (!config[origin_int].HasMember("sids") || !config[origin_int]["sids"].IsArray()) {
-		returnOut[0][1] = "Invalid SID - None Defined";
-		returnOut[0].back() = "Failed";
+	publishRules(data.rules);
+	finishLoad(data);
 
-		returnOut[1][1] = "Invalid SID - " + origin + " exists in database but has no SIDs defined.";
-		returnOut[1].back() = "Failed";
-		return returnOut;
+	if (snapshot) {
+		saveSnapshot(*data.rules);
 	}
-	size_t pos = string::npos;
+}
 
-	for (size_t i = 0; i < config[origin_int]["sids"].Size(); i++) {
-		if (config[origin_int]["sids"][i].HasMember("point") && !first_wp.compare(config[origin_int]["sids"][i]["point"].GetString()) && config[origin_int]["sids"][i].HasMember("constraints") && config[origin_int]["sids"][i]["constraints"].IsArray()) {
-			pos = i;
-		}
+//Returns the block the next load parses into, grown to fit the last load so the same data needs no further allocations
+vector<char>& CVFPCPlugin::getParseBlock() {
+	if (parseBlock.size() < parseBlockSize) {
+		parseBlock = vector<char>(parseBlockSize);
 	}
 
-	// Needed SID defined
-	if (pos != string::npos) {
-		const Value& sid_ele = config[origin_int]["sids"][pos];
-		const Value& conditions = sid_ele["constraints"];
-
-		int round = 0;
+	return parseBlock;
+}
 
-		vector<bool> validity, new_validity;
-		vector<string> results;
-		bool sidFails[3]{ 0 };
-		bool restFails[3]{ 0 }; // 0 = Suffix, 1 = Aircraft/Engines, 2 = Date/Time Restrictions
-		int Min, Max;
+//Logs the time and peak memory of a load, and grows the parse block for the next one to the pool size a DOM load used plus an eighth
+void CVFPCPlugin::finishLoad(SidData& data) {
+	if (data.source.empty()) {
+		return;
+	}
 
-		//SID-Level Restrictions Array
-		bool sidwide = true;
-		sidFails[0] = true;
-		if (sid_ele["restrictions"].IsArray() && sid_ele["restrictions"].Size()) {
-			sidwide = false;
-			for (size_t j = 0; j < sid_ele["restrictions"].Size(); j++) {
-				bool temp = true;
+	//The pool's first chunk is the parse block, anything beyond it was allocated by this load
+	size_t block = parseBlock.size();
+	size_t pool = data.pool.Capacity();
+	size_t further = pool > block ? pool - block : 0;
 
-				if (sid_ele["restrictions"][j]["types"].IsArray() && sid_ele["restrictions"][j]["types"].Size()) {
-					sidFails[1] = true;
-					if (!arrayContains(sid_ele["restrictions"][j]["types"], flightPlan.GetFlightPlanData().GetEngineType()) &&
-						!arrayContains(sid_ele["restrictions"][j]["types"], flightPlan.GetFlightPlanData().GetAircraftType())) {
-						temp = false;
-					}
-				}
-
-				if (sid_ele["restrictions"][j]["suffix"].IsArray() && sid_ele["restrictions"][j]["suffix"].Size()) {
-					if (arrayContainsEnding(sid_ele["restrictions"][j]["suffix"], sid_suffix)) {
-						sidFails[0] = false;
-					}
-					else {
-						temp = false;
-					}
-				}
-				else {
-					sidFails[0] = false;
-				}
+	if (!data.stream) {
+		parseBlockSize = data.pool.Size() + data.pool.Size() / 8;
+	}
 
-				if (sid_ele["restrictions"][j].HasMember("start") && sid_ele["restrictions"][j].HasMember("end")) {
-					bool date = false;
-					bool time = false;
+	debugMessage("Info", str(boost::format("%s: %u airports in %.2f ms, peak %u bytes (%u text, %u parse block, %u further pool chunks), next parse block %u bytes")
+		% data.source % data.rules->airports.size() % data.parseMs % (data.length + block + further) % data.length % block % further % max(block, parseBlockSize)));
+}
 
-					int startdate;
-					int enddate;
-					int starttime[2] = { 0,0 };
-					int endtime[2] = { 0,0 };
+//Swaps rules compiled off to the side in for readers
+void CVFPCPlugin::publishRules(std::shared_ptr<SidRuleset> next) {
+	lock_guard<mutex> lock(publishMutex);
+	next->generation = rulesGeneration + 1;
+	std::atomic_store(&publishedRules, std::shared_ptr<const SidRuleset>(next));
+	rulesGeneration.store(next->generation);
+}
 
-					if (sid_ele["restrictions"][j]["start"].HasMember("date")
-						&& sid_ele["restrictions"][j]["start"]["date"].IsInt()
-						&& sid_ele["restrictions"][j]["end"].HasMember("date")
-						&& sid_ele["restrictions"][j]["end"]["date"].IsInt()) {
-						date = true;
+//Returns the latest published rules, refreshing a reader's held copy only if a newer generation was published since
+const std::shared_ptr<const SidRuleset>& CVFPCPlugin::readRules(std::shared_ptr<const SidRuleset>& held) {
+	if (!held || held->generation != rulesGeneration.load()) {
+		held = std::atomic_load(&publishedRules);
+	}
 
-						startdate = sid_ele["restrictions"][j]["start"]["date"].GetInt();
-						enddate = sid_ele["restrictions"][j]["end"]["date"].GetInt();
-					}
+	return held;
+}
 
-					if (sid_ele["restrictions"][j]["start"].HasMember("time")
-						&& sid_ele["restrictions"][j]["start"]["time"].IsString()
-						&& sid_ele["restrictions"][j]["end"].HasMember("time")
-						&& sid_ele["restrictions"][j]["end"]["time"].IsString()) {
-						time = true;
+//Checks flight plan
+CheckResult CVFPCPlugin::validizeSid(const FlightPlanSnapshot& flightPlan, const std::shared_ptr<const SidRuleset>& ruleset) {
+	return checkFlightPlan(flightPlan, ruleset, getTimeKey());
+}
 
-						string startstring = sid_ele["restrictions"][j]["start"]["time"].GetString();
-						string endstring = sid_ele["restrictions"][j]["end"]["time"].GetString();
+//Renders the normal and debug output of a check. Must use the ruleset the check was run against.
+vector<vector<string>> CVFPCPlugin::renderCheck(const FlightPlanSnapshot& flightPlan, const CheckResult& result) {
+	//out[0] = Normal Output, out[1] = Debug Output
+	vector<vector<string>> returnOut = { vector<string>(), vector<string>() }; // 0 = Callsign, 1 = SID, 2 = Destination, 3 = Route, 4 = Nav Performance, 5 = Min/Max Flight Level, 6 = Even/Odd, 7 = Suffix, 8 = Aircraft Type, 9 = Date/Time, 10 = Syntax, 11 = Passed/Failed
 
-						starttime[0] = stoi(startstring.substr(0, 2));
-						starttime[1] = stoi(startstring.substr(2, 2));
-						endtime[0] = stoi(endstring.substr(0, 2));
-						endtime[1] = stoi(endstring.substr(2, 2));
-					}
+	returnOut[0].push_back(flightPlan.callsign);
+	returnOut[1].push_back(flightPlan.callsign);
+	for (int i = 1; i < 11; i++) {
+		returnOut[0].push_back("-");
+		returnOut[1].push_back("-");
+	}
 
-					bool valid = true;
-
-					if (date || time) {
-						sidFails[2] = true;
-						valid = false;
-
-						if (!date && time) {
-							if (starttime[0] > endtime[0] || (starttime[0] == endtime[0] && starttime[1] >= endtime[1])) {
-								if (timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1]) || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1])) {
-									valid = true;
-								}
-							}
-							else {
-								if ((timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) && (timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1]))) {
-									valid = true;
-								}
-							}
-						}
-						else if (startdate == enddate) {
-							if (!time) {
-								valid = true;
-							}
-							else if ((timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) && (timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1]))) {
-								valid = true;
-							}
-						}
-						else if (startdate < enddate) {
-							if (timedata[0] > startdate && timedata[0] < enddate) {
-								valid = true;
-							}
-							else if (timedata[0] == startdate) {
-								if (!time || timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) {
-									valid = true;
-								}
-							}
-							else if (timedata[0] == enddate) {
-								if (!time || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] < endtime[1])) {
-									valid = true;
-								}
-							}
-						}
-						else if (startdate > enddate) {
-							if (timedata[0] < startdate || timedata[0] > enddate) {
-								valid = true;
-							}
-							else if (timedata[0] == startdate) {
-								if (!time || timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) {
-									valid = true;
-								}
-							}
-							else if (timedata[0] == enddate) {
-								if (!time || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] < endtime[1])) {
-									valid = true;
-								}
-							}
-						}
-					}
+	returnOut[1].back() = returnOut[0].back() = result.passed ? "Passed" : "Failed";
 
-					if (!valid) {
-						temp = false;
-					}
-				}
+	const SidRuleset& rules = *result.rules;
+	string origin = flightPlan.origin; boost::to_upper(origin);
+	string destination = flightPlan.destination; boost::to_upper(destination);
+	const AirportRules* airport = rules.find(origin);
 
-				if (temp) {
-					sidwide = true;
-				}
-			}
-		}
+	string sid;
+	string first_wp;
+	string sid_suffix;
+	if (airport != nullptr) {
+		splitSid(*airport, flightPlan.sidName, sid, first_wp, sid_suffix);
+	}
 
-		//Initialise validity array to fully true#
-		for (SizeType i = 0; i < conditions.Size(); i++) {
-			validity.push_back(true);
-		}
-			
-		//Constraints Array
-		while (round < 6) {
-			new_validity = {};
-
-			for (SizeType i = 0; i < conditions.Size(); i++) {
-				if (round == 0 || validity[i]) {
-					switch (round) {
-					case 0:
-					{
-						//Destinations
-						bool res = true;
-
-						if (conditions[i]["nodests"].IsArray() && conditions[i]["nodests"].Size()) {
-							string dest;
-							if (destArrayContains(conditions[i]["nodests"], destination.c_str()).size()) {
-								res = false;
-							}
-						}
-
-						if (conditions[i]["dests"].IsArray() && conditions[i]["dests"].Size()) {
-							string dest;
-							if (!destArrayContains(conditions[i]["dests"], destination.c_str()).size()) {
-								res = false;
-							}
-						}
-
-						new_validity.push_back(res);
-						break;
-					}
-					case 1:
-					{
-						//Route
-						bool res = true;
-
-						if (conditions[i].HasMember("route") && conditions[i]["route"].IsArray() && conditions[i]["route"].Size() && !routeContains(flightPlan.GetCallsign(), route, conditions[i]["route"])) {
-							res = false;
-						}
-
-						if (conditions[i].HasMember("points") && conditions[i]["points"].IsArray() && conditions[i]["points"].Size()) {
-							bool temp = false;
-
-							for (string each : points) {
-								if (arrayContains(conditions[i]["points"], each)) {
-									temp = true;
-								}
-							}
-
-							if (!temp) {
-								res = false;
-							}
-						}
-
-						if (conditions[i].HasMember("noroute") && res && conditions[i]["noroute"].IsArray() && conditions[i]["noroute"].Size() && routeContains(flightPlan.GetCallsign(), route, conditions[i]["noroute"])) {
-							res = false;
-						}
-
-						if (conditions[i].HasMember("nopoints") && conditions[i]["nopoints"].IsArray() && conditions[i]["nopoints"].Size()) {
-							bool temp = false;
-
-							for (string each : points) {
-								if (arrayContains(conditions[i]["nopoints"], each)) {
-									temp = true;
-								}
-							}
-
-							if (temp) {
-								res = false;
-							}
-						}
-
-						new_validity.push_back(res);
-						break;
-					}
-					case 2:
-					{
-						//Nav Perf
-						/* if (conditions[i].HasMember("nav") && conditions[i]["nav"].IsString()) {
-							string navigation_constraints(conditions[i]["nav"].GetString());
-							if (string::npos == navigation_constraints.find_first_of(flightPlan.GetFlightPlanData().GetCapibilities())) {
-								new_validity.push_back(false);
-							}
-							else {
-								new_validity.push_back(true);
-							}
-						}
-						else {
-							new_validity.push_back(true);
-						} */
-
-						new_validity.push_back(true); //Check disabled until future release
-						break;
-					}
-					case 3:
-					{
-						bool res = true;
-
-						//Min Level
-						if (conditions[i].HasMember("min") && (Min = conditions[i]["min"].GetInt()) > 0 && (RFL / 100) < Min) {
-							res = false;
-						}
-
-						//Max Level
-						if (conditions[i].HasMember("max") && (Max = conditions[i]["max"].GetInt()) > 0 && (RFL / 100) > Max) {
-							res = false;
-						}
-
-						new_validity.push_back(res);
-						break;
-					}
-					case 4:
-					{
-						//Assume any level valid if no "EVEN" or "ODD" declaration
-						bool res = true;
-
-						//Even/Odd Levels
-						if (conditions[i].HasMember("dir") && conditions[i]["dir"].IsString()) {
-							string direction = conditions[i]["dir"].GetString();
-							boost::to_upper(direction);
-
-							if (direction == "EVEN") {
-								//Assume invalid until condition matched
-								res = false;
-
-								//Non-RVSM (Above FL410)
-								if ((RFL > 41000 && (RFL / 1000 - 41) % 4 == 2)) {
-									res = true;
-								}
-								//RVSM (FL290-410) or Below FL290
-								else if (RFL <= 41000 && (RFL / 1000) % 2 == 0) {
-									res = true;
-								}
-							}
-							else if (direction == "ODD") {
-								//Assume invalid until condition matched
-								res = false;
-
-								//Non-RVSM (Above FL410)
-								if ((RFL > 41000 && (RFL / 1000 - 41) % 4 == 0)) {
-									res = true;
-								}
-								//RVSM (FL290-410) or Below FL290
-								else if (RFL <= 41000 && (RFL / 1000) % 2 == 1) {
-									res = true;
-								}
-							}
-						}
-
-						new_validity.push_back(res);
-						break;
-					}
-					case 5:
-					{
-						bool res = true;
-						bool overridesid = false;
-
-						restFails[0] = true;
-						// Restrictions Array - Only test if SID-wide failed or is overriden for this constraint.
-						if (!sidwide || (conditions[i].HasMember("override") && conditions[i]["override"].IsBool() && conditions[i]["override"].GetBool())) {
-							res = false;
-							if (conditions[i]["restrictions"].IsArray() && conditions[i]["restrictions"].Size()) {
-								for (size_t j = 0; j < conditions[i]["restrictions"].Size(); j++) {
-									bool temp = true;
-
-									if (conditions[i]["restrictions"][j]["types"].IsArray() && conditions[i]["restrictions"][j]["types"].Size()) {
-										restFails[1] = true;
-										if (!arrayContains(conditions[i]["restrictions"][j]["types"], flightPlan.GetFlightPlanData().GetEngineType()) &&
-											!arrayContains(conditions[i]["restrictions"][j]["types"], flightPlan.GetFlightPlanData().GetAircraftType())) {
-											temp = false;
-										}
-									}
-
-									if (conditions[i]["restrictions"][j]["suffix"].IsArray() && conditions[i]["restrictions"][j]["suffix"].Size()) {
-										if (arrayContainsEnding(conditions[i]["restrictions"][j]["suffix"], sid_suffix)) {
-											restFails[0] = false;
-										}
-										else {
-											temp = false;
-										}
-									}
-									else {
-										restFails[0] = false;
-									}
-
-									if (conditions[i]["restrictions"][j].HasMember("start") && conditions[i]["restrictions"][j].HasMember("end")) {
-										bool date = false;
-										bool time = false;
-
-										int startdate;
-										int enddate;
-										int starttime[2] = { 0,0 };
-										int endtime[2] = { 0,0 };
-
-										if (conditions[i]["restrictions"][j]["start"].HasMember("date")
-											&& conditions[i]["restrictions"][j]["start"]["date"].IsInt()
-											&& conditions[i]["restrictions"][j]["end"].HasMember("date")
-											&& conditions[i]["restrictions"][j]["end"]["date"].IsInt()) {
-											date = true;
-
-											startdate = conditions[i]["restrictions"][j]["start"]["date"].GetInt();
-											enddate = conditions[i]["restrictions"][j]["end"]["date"].GetInt();
-										}
-
-										if (conditions[i]["restrictions"][j]["start"].HasMember("time")
-											&& conditions[i]["restrictions"][j]["start"]["time"].IsString()
-											&& conditions[i]["restrictions"][j]["end"].HasMember("time")
-											&& conditions[i]["restrictions"][j]["end"]["time"].IsString()) {
-											time = true;
-
-											string startstring = conditions[i]["restrictions"][j]["start"]["time"].GetString();
-											string endstring = conditions[i]["restrictions"][j]["end"]["time"].GetString();
-
-											starttime[0] = stoi(startstring.substr(0, 2));
-											starttime[1] = stoi(startstring.substr(2, 2));
-											endtime[0] = stoi(endstring.substr(0, 2));
-											endtime[1] = stoi(endstring.substr(2, 2));
-										}
-
-										bool valid = true;
-
-										if (date || time) {
-											restFails[2] = true;
-											valid = false;
-
-											if (!date && time) {
-												if (starttime[0] > endtime[0] || (starttime[0] == endtime[0] && starttime[1] >= endtime[1])) {
-													if (timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1]) || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1])) {
-														valid = true;
-													}
-												}
-												else {
-													if ((timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) && (timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1]))) {
-														valid = true;
-													}
-												}
-											}
-											else if (startdate == enddate) {
-												if (!time) {
-													valid = true;
-												}
-												else if ((timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) && (timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] <= endtime[1]))) {
-													valid = true;
-												}
-											}
-											else if (startdate < enddate) {
-												if (timedata[0] > startdate && timedata[0] < enddate) {
-													valid = true;
-												}
-												else if (timedata[0] == startdate) {
-													if (!time || timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) {
-														valid = true;
-													}
-												}
-												else if (timedata[0] == enddate) {
-													if (!time || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] < endtime[1])) {
-														valid = true;
-													}
-												}
-											}
-											else if (startdate > enddate) {
-												if (timedata[0] < startdate || timedata[0] > enddate) {
-													valid = true;
-												}
-												else if (timedata[0] == startdate) {
-													if (!time || timedata[1] > starttime[0] || (timedata[1] == starttime[0] && timedata[2] >= starttime[1])) {
-														valid = true;
-													}
-												}
-												else if (timedata[0] == enddate) {
-													if (!time || timedata[1] < endtime[0] || (timedata[1] == endtime[0] && timedata[2] < endtime[1])) {
-														valid = true;
-													}
-												}
-											}
-										}
-
-										if (!valid) {
-											temp = false;
-										}
-									}
-
-									if (temp) {
-										res = true;
-									}
-								}
-							}
-						}
-
-						new_validity.push_back(res);
-						break;
-					}
-					}
-				}
-				else {
-					new_validity.push_back(false);
-				}
-			}
+	if (result.syntax != RouteError::None) {
+		RouteTokenizer tokenizer;
+		tokenizer.tokenize(flightPlan.route);
 
-			if (all_of(new_validity.begin(), new_validity.end(), [](bool v) { return !v; })) {
-				break;
-			}
-			else {
-				validity = new_validity;
-				round++;
-			}
+		if (result.syntax == RouteError::SpeedLevel) {
+			returnOut[0][returnOut[0].size() - 2] = "Invalid Speed/Level Change";
 		}
-
-		returnOut[1][0] = returnOut[0][0] = flightPlan.GetCallsign();
-		for (size_t i = 1; i < returnOut[0].size(); i++) {
-			returnOut[1][i] = returnOut[0][i] = "-";
+		else {
+			returnOut[0][returnOut[0].size() - 2] = "Invalid Syntax - Too Many \"/\" Characters in One or More Waypoints";
 		}
 
-		returnOut[1].back() = returnOut[0].back() = "Failed";
-
-		returnOut[1][1] = returnOut[0][1] = "Valid SID - " + sid + ".";
+		returnOut[1][returnOut[1].size() - 2] = "Invalid Route Item: " + tokenizer.invalid.to_string();
+		return returnOut;
+	}
 
-		if (sidwide || round == 6) {
-			vector<size_t> successes{};
+	switch (result.sid) {
+	case SidStatus::AirportNotFound:
+	{
+		returnOut[0][1] = "Invalid SID - Airport Not Found";
+		returnOut[1][1] = "Invalid SID - " + origin + " not in database.";
+		return returnOut;
+	}
+	case SidStatus::NoneSet:
+	{
+		returnOut[0][1] = returnOut[1][1] = "Invalid SID - None Set";
+		return returnOut;
+	}
+	case SidStatus::WrongFirstFix:
+	{
+		returnOut[0][1] = "Invalid SID - Route Not From Final SID Fix";
+		returnOut[1][1] = "Invalid SID - Route must start at " + first_wp + ".";
+		return returnOut;
+	}
+	case SidStatus::NoneDefined:
+	{
+		returnOut[0][1] = "Invalid SID - None Defined";
+		returnOut[1][1] = "Invalid SID - " + origin + " exists in database but has no SIDs defined.";
+		return returnOut;
+	}
+	case SidStatus::NotFound:
+	{
+		returnOut[0][1] = "Invalid SID - SID Not Found";
+		returnOut[1][1] = "Invalid SID - " + sid + " departure not in database.";
+		return returnOut;
+	}
+	case SidStatus::Valid:
+	{
+		break;
+	}
+	}
 
-			for (size_t i = 0; i < validity.size(); i++) {
-				if (validity[i]) {
-					successes.push_back(i);
-				}
-			}
+	const SidRule& sid_ele = airport->sids[result.sidIndex];
 
-			switch (round) {
-			case 6:
-			{
-				returnOut[0][8] = "Passed SID Restrictions.";
-				returnOut[1][8] = "Passed "; //RestrictionsOutput(origin_int, pos, successes, restFails[1], restFails[2]);
+	WaypointIds pointIds;
+	rules.waypointIds(flightPlan.points, pointIds);
 
-				returnOut[1].back() = returnOut[0].back() = "Passed";
-			}
-			case 5:
-			{
-				returnOut[0][7] = "Valid Suffix.";
-				returnOut[1][7] = "Valid " + SuffixOutput(origin_int, pos, successes);
-
-				if (round == 5) {
-					if (restFails[0]) {
-						returnOut[1][7] = returnOut[0][7] = "Invalid " + SuffixOutput(origin_int, pos, successes);
-					}
-					else {
-						returnOut[1][8] = returnOut[0][8] = "Failed " + RestrictionsOutput(origin_int, pos, restFails[1], restFails[2], successes) + " " + AlternativesOutput(origin_int, pos, successes);
-					}
-				}
+	returnOut[1][1] = returnOut[0][1] = "Valid SID - " + sid + ".";
 
-				returnOut[0][6] = "Passed Level Direction.";
-				returnOut[1][6] = "Passed " + DirectionOutput(origin_int, pos, successes);
+	//Outputs of constraint checks list the constraints left before the round that eliminated them all
+	vector<size_t> successes{};
+	if (!result.sidLevel) {
+		for (size_t i = 0; i < sid_ele.constraints.size(); i++) {
+			if (result.survivors.test(i)) {
+				successes.push_back(i);
 			}
-			case 4:
-			{
-				if (round == 4) {
-					returnOut[1][6] = returnOut[0][6] = "Failed " + DirectionOutput(origin_int, pos, successes);
-				}
+		}
+	}
+	const bool* restFails = result.sidLevel ? result.sidFails : result.restFails;
 
-				returnOut[0][5] = "Passed Min/Max Level.";
-				returnOut[1][5] = "Passed " + MinMaxOutput(origin_int, pos, successes);
-			}
-			case 3:
-			{
-				if (round == 3) {
-					returnOut[1][5] = returnOut[0][5] = "Failed " + MinMaxOutput(origin_int, pos, successes);
-				}
+	if (result.destination == CheckStatus::Passed) {
+		returnOut[0][2] = "Passed Destination.";
+		returnOut[1][2] = "Passed " + DestinationOutput(*airport, destination);
+	}
+	else if (result.destination == CheckStatus::Failed) {
+		returnOut[1][2] = returnOut[0][2] = "Failed " + DestinationOutput(*airport, destination);
+	}
 
-				returnOut[0][4] = "Passed Navigation Performance.";
-				returnOut[1][4] = "Passed " + NavPerfOutput(origin_int, pos, successes);
-			}
+	if (result.route == CheckStatus::Passed) {
+		returnOut[0][3] = "Passed Route.";
+		returnOut[1][3] = "Passed " + RouteOutput(sid_ele, successes, pointIds);
+	}
+	else if (result.route == CheckStatus::Failed) {
+		returnOut[1][3] = returnOut[0][3] = "Failed " + RouteOutput(sid_ele, successes, pointIds);
+	}
 
-			case 2:
-			{
-				if (round == 2) {
-					returnOut[1][4] = returnOut[0][4] = "Failed " + NavPerfOutput(origin_int, pos, successes);
-				}
+	if (result.nav == CheckStatus::Passed) {
+		returnOut[0][4] = "Passed Navigation Performance.";
+		returnOut[1][4] = "Passed " + NavPerfOutput(sid_ele, successes);
+	}
+	else if (result.nav == CheckStatus::Failed) {
+		returnOut[1][4] = returnOut[0][4] = "Failed " + NavPerfOutput(sid_ele, successes);
+	}
 
-				returnOut[0][3] = "Passed Route.";
-				returnOut[1][3] = "Passed " + RouteOutput(origin_int, pos, successes, points);
-			}
-			case 1:
-			{
-				if (round == 1) {
-					returnOut[1][3] = returnOut[0][3] = "Failed " + RouteOutput(origin_int, pos, successes, points);
-				}
+	if (result.level == CheckStatus::Passed) {
+		returnOut[0][5] = "Passed Min/Max Level.";
+		returnOut[1][5] = "Passed " + MinMaxOutput(sid_ele, successes);
+	}
+	else if (result.level == CheckStatus::Failed) {
+		returnOut[1][5] = returnOut[0][5] = "Failed " + MinMaxOutput(sid_ele, successes);
+	}
 
-				returnOut[0][2] = "Passed Destination.";
-				returnOut[1][2] = "Passed " + DestinationOutput(origin_int, destination);
-			}
-			case 0:
-			{
-				if (round == 0) {
-					returnOut[1][2] = returnOut[0][2] = "Failed " + DestinationOutput(origin_int, destination);
-				}
-				break;
-			}
-			}
-		}
-		else {
-			if (sidFails[0]) {
-				returnOut[1][7] = returnOut[0][7] = "Invalid " + SuffixOutput(origin_int, pos);
-			}
-			else {
-				returnOut[0][7] = "Valid Suffix.";
-				returnOut[1][7] = "Valid " + SuffixOutput(origin_int, pos);
+	if (result.direction == CheckStatus::Passed) {
+		returnOut[0][6] = "Passed Level Direction.";
+		returnOut[1][6] = "Passed " + DirectionOutput(sid_ele, successes);
+	}
+	else if (result.direction == CheckStatus::Failed) {
+		returnOut[1][6] = returnOut[0][6] = "Failed " + DirectionOutput(sid_ele, successes);
+	}
 
-				//sidFails[1] or [2] must be false to get here
-				returnOut[1][8] = returnOut[0][8] = "Failed " + RestrictionsOutput(origin_int, pos, sidFails[1], sidFails[2]) + " " + AlternativesOutput(origin_int, pos);
-			}
-		}
+	if (result.suffix == CheckStatus::Passed) {
+		returnOut[0][7] = "Valid Suffix.";
+		returnOut[1][7] = "Valid " + SuffixOutput(sid_ele, successes);
+	}
+	else if (result.suffix == CheckStatus::Failed) {
+		returnOut[1][7] = returnOut[0][7] = "Invalid " + SuffixOutput(sid_ele, successes);
+	}
 
-		return returnOut;
+	if (result.restrictions == CheckStatus::Passed) {
+		returnOut[0][8] = "Passed SID Restrictions.";
+		returnOut[1][8] = "Passed "; //RestrictionsOutput(sid_ele, successes, result.restFails[1], result.restFails[2]);
 	}
-	else {
-		returnOut[0][1] = "Invalid SID - SID Not Found";
-		returnOut[1][1] = "Invalid SID - " + sid + " departure not in database.";
-		returnOut[1].back() = returnOut[0].back() = "Failed";
-		return returnOut;
+	else if (result.restrictions == CheckStatus::Failed) {
+		returnOut[1][8] = returnOut[0][8] = "Failed " + RestrictionsOutput(sid_ele, restFails[1], restFails[2], successes) + " " + AlternativesOutput(sid_ele, successes);
 	}
+
+	return returnOut;
+}
+
+//Splits a SID name into its cleaned name, first waypoint and suffix
+void CVFPCPlugin::splitSid(const AirportRules& airport, const string& sidName, string& sid, string& first_wp, string& sid_suffix) {
+	::splitSid(airport, sidName, sid, first_wp, sid_suffix);
 }
 
 //Outputs recommended alternatives (from Restrictions array) as string
-string CVFPCPlugin::AlternativesOutput(size_t origin_int, size_t pos, vector<size_t> successes) {
+string CVFPCPlugin::AlternativesOutput(const SidRule& sid_ele, vector<size_t> successes) {
 	string out = "";
-	const Value& sid_ele = config[origin_int]["sids"][pos];
-	const Value& conditions = sid_ele["constraints"];
-
-	if (sid_ele["restrictions"].IsArray() && sid_ele["restrictions"].Size()) {
-		for (size_t i = 0; i < sid_ele["restrictions"].Size(); i++) {
-			if (sid_ele["restrictions"][i]["alt"].IsArray() && sid_ele["restrictions"][i]["alt"].Size()) {
-				for (size_t j = 0; j < sid_ele["restrictions"][i]["alt"].Size(); j++) {
-					if (sid_ele["restrictions"][i]["alt"][j].IsString()) {
-						out += sid_ele["restrictions"][i]["alt"][j].GetString();
-						out += ", ";
-					}
-				}
-			}
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
+
+	for (const SidRestriction& rest : sid_ele.restrictions) {
+		for (const string& alt : rest.alt) {
+			out += alt;
+			out += ", ";
 		}
 	}
 
 	for (size_t each : successes) {
-		if (conditions[each]["restrictions"].IsArray() && conditions[each]["restrictions"].Size()) {
-			for (size_t i = 0; i < conditions[each]["restrictions"].Size(); i++) {
-				if (conditions[each]["restrictions"][i]["alt"].IsArray() && conditions[each]["restrictions"][i]["alt"].Size()) {
-					for (size_t j = 0; j < conditions[each]["restrictions"][i]["alt"].Size(); j++) {
-						if (conditions[each]["restrictions"][i]["alt"][j].IsString()) {
-							out += conditions[each]["restrictions"][i]["alt"][j].GetString();
-							out += ", ";
-						}
-					}
-				}
+		for (const SidRestriction& rest : conditions[each].restrictions) {
+			for (const string& alt : rest.alt) {
+				out += alt;
+				out += ", ";
 			}
 		}
 	}
@@ -1060,201 +860,69 @@ string CVFPCPlugin::AlternativesOutput(size_t origin_int, size_t pos, vector<siz
 }
 
 //Outputs aircraft type and date/time restrictions (from Restrictions array) as string
-string CVFPCPlugin::RestrictionsOutput(size_t origin_int, size_t pos, bool check_type, bool check_time, vector<size_t> successes) {
+string CVFPCPlugin::RestrictionsOutput(const SidRule& sid_ele, bool check_type, bool check_time, vector<size_t> successes) {
 	vector<vector<string>> rests{};
-	const Value& sid_ele = config[origin_int]["sids"][pos];
-	const Value& conditions = sid_ele["constraints"];
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
+
+	vector<const vector<SidRestriction>*> sources{ &sid_ele.restrictions };
+	for (size_t each : successes) {
+		sources.push_back(&conditions[each].restrictions);
+	}
 
-	if (sid_ele["restrictions"].IsArray() && sid_ele["restrictions"].Size()) {
-		for (size_t i = 0; i < sid_ele["restrictions"].Size(); i++) {
+	for (const vector<SidRestriction>* source : sources) {
+		for (const SidRestriction& rest : *source) {
 			vector<string> this_rest { "", "" };
 
-			if (sid_ele["restrictions"][i]["types"].IsArray() && sid_ele["restrictions"][i]["types"].Size()) {
-				for (size_t j = 0; j < sid_ele["restrictions"][i]["types"].Size(); j++) {
-					if (sid_ele["restrictions"][i]["types"][j].IsString()) {
-						string item = sid_ele["restrictions"][i]["types"][j].GetString();
-
-						if (item.size() == 1) {
-							if (item == "P") {
-								this_rest[0] += "All Pistons";
-							}
-							else if (item == "T") {
-								this_rest[0] += "All Turboprops";
-							}
-							else if (item == "J") {
-								this_rest[0] += "All Jets";
-							}
-							else if (item == "E") {
-								this_rest[0] += "All Electric Aircraft";
-							}
-						}
-						else {
-							this_rest[0] += item;
-						}
-
-						this_rest[0] += ", ";
+			for (const string& item : rest.types) {
+				if (item.size() == 1) {
+					if (item == "P") {
+						this_rest[0] += "All Pistons";
+					}
+					else if (item == "T") {
+						this_rest[0] += "All Turboprops";
+					}
+					else if (item == "J") {
+						this_rest[0] += "All Jets";
+					}
+					else if (item == "E") {
+						this_rest[0] += "All Electric Aircraft";
 					}
 				}
-
-				if (this_rest[0] != "") {
-					this_rest[0] = this_rest[0].substr(0, this_rest[0].size() - 2);
-				}
-			}
-
-			if (sid_ele["restrictions"][i].HasMember("start") && sid_ele["restrictions"][i].HasMember("end")) {
-				bool date = false;
-				bool time = false;
-				int startdate;
-				int enddate;
-				string starttime;
-				string endtime;
-
-				if (sid_ele["restrictions"][i]["start"].HasMember("date")
-					&& sid_ele["restrictions"][i]["start"]["date"].IsInt()
-					&& sid_ele["restrictions"][i]["end"].HasMember("date")
-					&& sid_ele["restrictions"][i]["end"]["date"].IsInt()) {
-					date = true;
-
-					startdate = sid_ele["restrictions"][i]["start"]["date"].GetInt();
-					enddate = sid_ele["restrictions"][i]["end"]["date"].GetInt();
+				else {
+					this_rest[0] += item;
 				}
 
-				if (sid_ele["restrictions"][i]["start"].HasMember("time")
-					&& sid_ele["restrictions"][i]["start"]["time"].IsString()
-					&& sid_ele["restrictions"][i]["end"].HasMember("time")
-					&& sid_ele["restrictions"][i]["end"]["time"].IsString()) {
-					time = true;
-
-					string startstring = sid_ele["restrictions"][i]["start"]["time"].GetString();
-					string endstring = sid_ele["restrictions"][i]["end"]["time"].GetString();
-
-					starttime = startstring.substr(0, 2) + ":" + startstring.substr(2, 2);
-					endtime = endstring.substr(0, 2) + ":" + endstring.substr(2, 2);
-				}
+				this_rest[0] += ", ";
+			}
 
-				string start = "";
-				string end = "";
+			if (this_rest[0] != "") {
+				this_rest[0] = this_rest[0].substr(0, this_rest[0].size() - 2);
+			}
 
-				if (date) {
-					start += dayIntToString(startdate);
-					end += dayIntToString(enddate);
-				}
+			string start = "";
+			string end = "";
 
-				if (time) {
-					if (date) {
-						start += " ";
-						end += " ";
-					}
+			if (rest.date) {
+				start += dayIntToString(rest.startDate);
+				end += dayIntToString(rest.endDate);
+			}
 
-					start += starttime;
-					end += endtime;
+			if (rest.time) {
+				if (rest.date) {
+					start += " ";
+					end += " ";
 				}
 
-				if (start != "" && end != "") {
-					this_rest[1] = start + " and " + end;
-				}
+				start += str(boost::format("%02d:%02d") % rest.startTime[0] % rest.startTime[1]);
+				end += str(boost::format("%02d:%02d") % rest.endTime[0] % rest.endTime[1]);
 			}
 
-			if (!all_of(this_rest[0].begin(), this_rest[0].end(), isspace) || !all_of(this_rest[1].begin(), this_rest[1].end(), isspace)) {
-				rests.push_back(this_rest);
+			if (start != "" && end != "") {
+				this_rest[1] = start + " and " + end;
 			}
-		}
-	}
-
-	for (size_t each : successes) {
-		if (conditions[each]["restrictions"].IsArray() && conditions[each]["restrictions"].Size()) {
-			for (size_t i = 0; i < conditions[each]["restrictions"].Size(); i++) {
-				vector<string> this_rest { "", "" };
-
-				if (conditions[each]["restrictions"][i]["types"].IsArray() && conditions[each]["restrictions"][i]["types"].Size()) {
-					for (size_t j = 0; j < conditions[each]["restrictions"][i]["types"].Size(); j++) {
-						if (conditions[each]["restrictions"][i]["types"][j].IsString()) {
-							string item = conditions[each]["restrictions"][i]["types"][j].GetString();
-
-							if (item.size() == 1) {
-								if (item == "P") {
-									this_rest[0] += "All Pistons";
-								}
-								else if (item == "T") {
-									this_rest[0] += "All Turboprops";
-								}
-								else if (item == "J") {
-									this_rest[0] += "All Jets";
-								}
-								else if (item == "E") {
-									this_rest[0] += "All Electric Aircraft";
-								}
-							}
-							else {
-								this_rest[0] += item;
-							}
-
-							this_rest[0] += ", ";
-						}
-					}
-
-					if (this_rest[0] != "") {
-						this_rest[0] = this_rest[0].substr(0, this_rest[0].size() - 2);
-					}
-				}
 
-				if (conditions[each]["restrictions"][i].HasMember("start") && conditions[each]["restrictions"][i].HasMember("end")) {
-					bool date = false;
-					bool time = false;
-					int startdate;
-					int enddate;
-					string starttime;
-					string endtime;
-
-					if (conditions[each]["restrictions"][i]["start"].HasMember("date")
-						&& conditions[each]["restrictions"][i]["start"]["date"].IsInt()
-						&& conditions[each]["restrictions"][i]["end"].HasMember("date")
-						&& conditions[each]["restrictions"][i]["end"]["date"].IsInt()) {
-						date = true;
-
-						startdate = conditions[each]["restrictions"][i]["start"]["date"].GetInt();
-						enddate = conditions[each]["restrictions"][i]["end"]["date"].GetInt();
-					}
-
-					if (conditions[each]["restrictions"][i]["start"].HasMember("time")
-						&& conditions[each]["restrictions"][i]["start"]["time"].IsString()
-						&& conditions[each]["restrictions"][i]["end"].HasMember("time")
-						&& conditions[each]["restrictions"][i]["end"]["time"].IsString()) {
-						time = true;
-
-						string startstring = conditions[each]["restrictions"][i]["start"]["time"].GetString();
-						string endstring = conditions[each]["restrictions"][i]["end"]["time"].GetString();
-
-						starttime = startstring.substr(0, 2) + ":" + startstring.substr(2, 2);
-						endtime = endstring.substr(0, 2) + ":" + endstring.substr(2, 2);
-					}
-
-					string start = "";
-					string end = "";
-
-					if (date) {
-						start += dayIntToString(startdate);
-						end += dayIntToString(enddate);
-					}
-
-					if (time) {
-						if (date) {
-							start += " ";
-							end += " ";
-						}
-
-						start += starttime;
-						end += endtime;
-					}
-
-					if (start != "" && end != "") {
-						this_rest[1] = start + " and " + end;
-					}
-				}
-
-				if (!all_of(this_rest[0].begin(), this_rest[0].end(), isspace) || !all_of(this_rest[1].begin(), this_rest[1].end(), isspace)) {
-					rests.push_back(this_rest);
-				}
+			if (!all_of(this_rest[0].begin(), this_rest[0].end(), ::isspace) || !all_of(this_rest[1].begin(), this_rest[1].end(), ::isspace)) {
+				rests.push_back(this_rest);
 			}
 		}
 	}
@@ -1286,34 +954,17 @@ string CVFPCPlugin::RestrictionsOutput(size_t origin_int, size_t pos, bool check
 }
 
 //Outputs valid suffices (from Restrictions array) as string
-string CVFPCPlugin::SuffixOutput(size_t origin_int, size_t pos, vector<size_t> successes) {
+string CVFPCPlugin::SuffixOutput(const SidRule& sid_ele, vector<size_t> successes) {
 	vector<string> suffices{};
-	const Value& sid_eles = config[origin_int]["sids"][pos];
-	const Value& conditions = sid_eles["constraints"];
-
-	if (sid_eles["restrictions"].IsArray() && sid_eles["restrictions"].Size()) {
-		for (size_t i = 0; i < sid_eles["restrictions"].Size(); i++) {
-			if (sid_eles["restrictions"][i]["suffix"].IsArray() && sid_eles["restrictions"][i]["suffix"].Size()) {
-				for (size_t j = 0; j < sid_eles["restrictions"][i]["suffix"].Size(); j++) {
-					if (sid_eles["restrictions"][i]["suffix"][j].IsString()) {
-						suffices.push_back(sid_eles["restrictions"][i]["suffix"][j].GetString());
-					}
-				}
-			}
-		}
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
+
+	for (const SidRestriction& rest : sid_ele.restrictions) {
+		suffices.insert(suffices.end(), rest.suffix.begin(), rest.suffix.end());
 	}
 
 	for (size_t each : successes) {
-		if (conditions[each]["restrictions"].IsArray() && conditions[each]["restrictions"].Size()) {
-			for (size_t i = 0; i < conditions[each]["restrictions"].Size(); i++) {
-				if (conditions[each]["restrictions"][i]["suffix"].IsArray() && conditions[each]["restrictions"][i]["suffix"].Size()) {
-					for (size_t j = 0; j < conditions[each]["restrictions"][i]["suffix"].Size(); j++) {
-						if (conditions[each]["restrictions"][i]["suffix"][j].IsString()) {
-							suffices.push_back(conditions[each]["restrictions"][i]["suffix"][j].GetString());
-						}
-					}
-				}
-			}
+		for (const SidRestriction& rest : conditions[each].restrictions) {
+			suffices.insert(suffices.end(), rest.suffix.begin(), rest.suffix.end());
 		}
 	}
 
@@ -1322,7 +973,7 @@ string CVFPCPlugin::SuffixOutput(size_t origin_int, size_t pos, vector<size_t> s
 	sort(suffices.begin(), suffices.end());
 	vector<string>::iterator itr = unique(suffices.begin(), suffices.end());
 	suffices.erase(itr, suffices.end());
-	
+
 	if (suffices.size() == 0) {
 		out += "Any.";
 	}
@@ -1338,20 +989,17 @@ string CVFPCPlugin::SuffixOutput(size_t origin_int, size_t pos, vector<size_t> s
 }
 
 //Outputs valid cruise level direction (from Constraints array) as string
-string CVFPCPlugin::DirectionOutput(size_t origin_int, size_t pos, vector<size_t> successes) {
-	const Value& conditions = config[origin_int]["sids"][pos]["constraints"];
+string CVFPCPlugin::DirectionOutput(const SidRule& sid_ele, vector<size_t> successes) {
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
 	bool lvls[2] { false, false };
-	for (int each : successes) {
-		if (conditions[each].HasMember("dir") && conditions[each]["dir"].IsString()) {
-			string val = conditions[each]["dir"].GetString();
-			if (val == "EVEN") {
-				lvls[0] = true;
-			}
-			else if (val == "ODD") {
-				lvls[1] = true;
-			}
+	for (size_t each : successes) {
+		if (conditions[each].dir == LevelDirection::Even) {
+			lvls[0] = true;
 		}
-		else {
+		else if (conditions[each].dir == LevelDirection::Odd) {
+			lvls[1] = true;
+		}
+		else if (conditions[each].dir == LevelDirection::Any) {
 			lvls[0] = true;
 			lvls[1] = true;
 		}
@@ -1376,18 +1024,18 @@ string CVFPCPlugin::DirectionOutput(size_t origin_int, size_t pos, vector<size_t
 }
 
 //Outputs valid cruise level blocks (from Constraints array) as string
-string CVFPCPlugin::MinMaxOutput(size_t origin_int, size_t pos, vector<size_t> successes) {
-	const Value& conditions = config[origin_int]["sids"][pos]["constraints"];
+string CVFPCPlugin::MinMaxOutput(const SidRule& sid_ele, vector<size_t> successes) {
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
 	vector<vector<int>> raw_lvls{};
-	for (int each : successes) {
+	for (size_t each : successes) {
 		vector<int> lvls = { MININT, MAXINT };
 
-		if (conditions[each].HasMember("min") && conditions[each]["min"].IsInt()) {
-			lvls[0] = conditions[each]["min"].GetInt();
+		if (conditions[each].hasMin) {
+			lvls[0] = conditions[each].min;
 		}
 
-		if (conditions[each].HasMember("max") && conditions[each]["max"].IsInt()) {
-			lvls[1] = conditions[each]["max"].GetInt();
+		if (conditions[each].hasMax) {
+			lvls[1] = conditions[each].max;
 		}
 
 		raw_lvls.push_back(lvls);
@@ -1453,12 +1101,12 @@ string CVFPCPlugin::MinMaxOutput(size_t origin_int, size_t pos, vector<size_t> s
 }
 
 //Outputs valid navigational performance (from Constraints array) as string
-string CVFPCPlugin::NavPerfOutput(size_t origin_int, size_t pos, vector<size_t> successes) {
-	const Value& conditions = config[origin_int]["sids"][pos]["constraints"];
+string CVFPCPlugin::NavPerfOutput(const SidRule& sid_ele, vector<size_t> successes) {
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
 	vector<string> navperf{};
-	for (int each : successes) {
-		if (conditions[each].HasMember("nav") && conditions[each]["nav"].IsString()) {
-			navperf.push_back(string(conditions[each]["nav"].GetString()));
+	for (size_t each : successes) {
+		if (conditions[each].hasNav) {
+			navperf.push_back(conditions[each].nav);
 		}
 	}
 
@@ -1483,49 +1131,37 @@ string CVFPCPlugin::NavPerfOutput(size_t origin_int, size_t pos, vector<size_t>
 }
 
 //Outputs valid initial routes (from Constraints array) as string
-string CVFPCPlugin::RouteOutput(size_t origin_int, size_t pos, vector<size_t> successes, vector<string> extracted_route) {
-	const Value& conditions = config[origin_int]["sids"][pos]["constraints"];
+string CVFPCPlugin::RouteOutput(const SidRule& sid_ele, vector<size_t> successes, const WaypointIds& extracted_route) {
+	const vector<SidConstraint>& conditions = sid_ele.constraints;
 	vector<string> outroute{};
 	bool all = false;
 
 	do {
-		for (int each : successes) {
+		for (size_t each : successes) {
 			bool contents[4]{ 0 };
 
-			if (conditions[each]["route"].IsArray() && conditions[each]["route"].Size()) {
+			if (conditions[each].route.size()) {
 				contents[0] = true;
 			}
-			if (conditions[each]["points"].IsArray() && conditions[each]["points"].Size()) {
+			if (conditions[each].points.size()) {
 				contents[1] = true;
 
 				if (!all) {
-					bool found = false;
-
-					for (string point : extracted_route) {
-						if (arrayContains(conditions[each]["points"], point)) {
-							found = true;
-						}
-					}
+					bool found = waypointsIntersect(conditions[each].pointIds, extracted_route);
 
 					if (!found) {
 						continue;
 					}
 				}
 			}
-			if (conditions[each]["noroute"].IsArray() && conditions[each]["noroute"].Size()) {
+			if (conditions[each].noroute.size()) {
 				contents[2] = true;
 			}
-			if (conditions[each]["nopoints"].IsArray() && conditions[each]["nopoints"].Size()) {
+			if (conditions[each].nopoints.size()) {
 				contents[3] = true;
 
 				if (!all) {
-					bool found = false;
-
-					for (string point : extracted_route) {
-						if (arrayContains(conditions[each]["points"], point)) {
-							found = true;
-						}
-					}
+					bool found = waypointsIntersect(conditions[each].pointIds, extracted_route);
 
 					if (found) {
 						continue;
@@ -1535,11 +1171,11 @@ string CVFPCPlugin::RouteOutput(size_t origin_int, size_t pos, vector<size_t> su
 
 			string out = "";
 			if (contents[0]) {
-				out += conditions[each]["route"][(SizeType)0].GetString();
+				out += conditions[each].route[0];
 
-				for (size_t j = 1; j < conditions[each]["route"].Size(); j++) {
+				for (size_t j = 1; j < conditions[each].route.size(); j++) {
 					out += " or ";
-					out += conditions[each]["route"][j].GetString();
+					out += conditions[each].route[j];
 				}
 			}
 
@@ -1549,11 +1185,11 @@ string CVFPCPlugin::RouteOutput(size_t origin_int, size_t pos, vector<size_t> su
 				}
 
 				out += "via ";
-				out += conditions[each]["points"][(size_t)0].GetString();
+				out += conditions[each].points[0];
 
-				for (size_t j = 1; j < conditions[each]["points"].Size(); j++) {
+				for (size_t j = 1; j < conditions[each].points.size(); j++) {
 					out += ", ";
-					out += conditions[each]["points"][j].GetString();
+					out += conditions[each].points[j];
 				}
 			}
 
@@ -1563,11 +1199,11 @@ string CVFPCPlugin::RouteOutput(size_t origin_int, size_t pos, vector<size_t> su
 				}
 
 				out += "not ";
-				out += conditions[each]["noroute"][(size_t)0].GetString();
+				out += conditions[each].noroute[0];
 
-				for (size_t j = 1; j < conditions[each]["noroute"].Size(); j++) {
+				for (size_t j = 1; j < conditions[each].noroute.size(); j++) {
 					out += ", ";
-					out += conditions[each]["noroute"][j].GetString();
+					out += conditions[each].noroute[j];
 				}
 			}
 
@@ -1583,25 +1219,18 @@ string CVFPCPlugin::RouteOutput(size_t origin_int, size_t pos, vector<size_t> su
 				}
 
 				out += "via ";
-				out += conditions[each]["nopoints"][(size_t)0].GetString();
+				out += conditions[each].nopoints[0];
 
-				for (size_t j = 1; j < conditions[each]["nopoints"].Size(); j++) {
+				for (size_t j = 1; j < conditions[each].nopoints.size(); j++) {
 					out += ", ";
-					out += conditions[each]["nopoints"][j].GetString();
+					out += conditions[each].nopoints[j];
 				}
 			}
 
-			int Min, Max;
-			bool min = false;
-			bool max = false;
-
-			if (conditions[each].HasMember("min") && conditions[each]["min"].IsInt() && (Min = conditions[each]["min"].GetInt()) > 0) {
-				min = true;
-			}
-
-			if (conditions[each].HasMember("max") && conditions[each]["max"].IsInt() && (Max = conditions[each]["max"].GetInt()) > 0) {
-				max = true;
-			}
+			int Min = conditions[each].min;
+			int Max = conditions[each].max;
+			bool min = conditions[each].hasMin && Min > 0;
+			bool max = conditions[each].hasMax && Max > 0;
 
 			if (min && max) {
 				out += " (FL" + to_string(Min) + " - " + to_string(Max) + ")";
@@ -1644,35 +1273,33 @@ string CVFPCPlugin::RouteOutput(size_t origin_int, size_t pos, vector<size_t> su
 }
 
 //Outputs valid destinations (from Constraints array) as string
-string CVFPCPlugin::DestinationOutput(size_t origin_int, string dest) {
+string CVFPCPlugin::DestinationOutput(const AirportRules& airport, string dest) {
 	vector<string> a{}; //Explicitly Permitted
 	vector<string> b{}; //Implicitly Permitted (Not Explicitly Prohibited)
+	uint32_t destKey = packIcao(dest);
 
-	for (size_t i = 0; i < config[origin_int]["sids"].Size(); i++) {
-		if (config[origin_int]["sids"][i].HasMember("point") && config[origin_int]["sids"][i]["point"].IsString()) {
-			bool push_a = false;
-			bool push_b = false;
+	for (const SidRule& sid_ele : airport.sids) {
+		bool push_a = false;
+		bool push_b = false;
 
-			const Value& conditions = config[origin_int]["sids"][i]["constraints"];
-			for (size_t j = 0; j < conditions.Size(); j++) {
-				if (conditions[j]["dests"].IsArray() && conditions[j]["dests"].Size()) {
-					if (destArrayContains(conditions[j]["dests"], dest) != "") {
-						push_a = true;
-					}
+		for (const SidConstraint& condition : sid_ele.constraints) {
+			if (condition.dests.size()) {
+				if (condition.destPrefixes.matches(destKey, dest)) {
+					push_a = true;
 				}
-				else if (conditions[j]["nodests"].IsArray() && conditions[j]["nodests"].Size()) {
-					if (destArrayContains(conditions[j]["nodests"], dest) == "") {
-						push_b = true;
-					}
+			}
+			else if (condition.nodests.size()) {
+				if (!condition.nodestPrefixes.matches(destKey, dest)) {
+					push_b = true;
 				}
 			}
+		}
 
-			if (push_a) {
-				a.push_back(config[origin_int]["sids"][i]["point"].GetString());
-			}
-			else if (push_b) {
-				b.push_back(config[origin_int]["sids"][i]["point"].GetString());
-			}
+		if (push_a) {
+			a.push_back(sid_ele.point);
+		}
+		else if (push_b) {
+			b.push_back(sid_ele.point);
 		}
 	}
 
@@ -1712,97 +1339,6 @@ string CVFPCPlugin::DestinationOutput(size_t origin_int, string dest) {
 	}
 
 	return "Destination. " + out;
-
-	/*const Value& conditions = config[origin_int]["sids"][pos]["constraints"];
-	vector<vector<string>> res{ vector<string>{}, vector<string>{} };
-
-	for (int each : successes) {
-		vector<string> good_new_eles{};
-		if (conditions[each].HasMember("dests") && conditions[each]["dests"].IsArray() && conditions[each]["dests"].Size()) {
-			for (SizeType j = 0; j < conditions[each]["dests"].Size(); j++) {
-				string dest = conditions[each]["dests"][j].GetString();
-
-				if (dest.size() < 4)
-					dest += string(4 - dest.size(), '*');
-
-				good_new_eles.push_back(dest);
-			}
-		}
-
-		vector<string> bad_new_eles{};
-		if (conditions[each].HasMember("nodests") && conditions[each]["nodests"].IsArray() && conditions[each]["nodests"].Size()) {
-			for (SizeType j = 0; j < conditions[each]["nodests"].Size(); j++) {
-				string dest = conditions[each]["nodests"][j].GetString();
-
-				if (dest.size() < 4)
-					dest += string(4 - dest.size(), '*');
-
-				bad_new_eles.push_back(dest);
-			}
-		}
-
-		bool added = false;
-		for (string dest : res[0]) {
-			//Remove Duplicates from Whitelist
-			for (size_t k = good_new_eles.size(); k > 0; k--) {
-				string new_ele = good_new_eles[k - 1];
-				if (new_ele.compare(dest) == 0) {
-					good_new_eles.erase(good_new_eles.begin() + k - 1);
-				}
-			}
-
-			//Prevent Previously Whitelisted Elements from Being Blacklisted
-			for (size_t k = bad_new_eles.size(); k > 0; k--) {
-				string new_ele = bad_new_eles[k - 1];
-				if (new_ele.compare(dest) == 0) {
-					bad_new_eles.erase(bad_new_eles.begin() + k - 1);
-				}
-			}
-		}
-
-		//Whitelist Previously Blacklisted Elements
-		for (string dest : good_new_eles) {
-
-			for (size_t k = res[1].size(); k > 0; k--) {
-				string new_ele = res[1][k - 1];
-				if (new_ele.compare(dest) == 0) {
-					res[1].erase(res[1].begin() + k - 1);
-				}
-			}
-		}
-
-		//Remove Duplicates from Blacklist
-		for (string dest : res[1]) {
-			for (size_t k = bad_new_eles.size(); k > 0; k--) {
-				string new_ele = bad_new_eles[k - 1];
-				if (new_ele.compare(dest) == 0) {
-					bad_new_eles.erase(bad_new_eles.begin() + k - 1);
-				}
-			}
-		}
-
-		res[0].insert(res[0].end(), good_new_eles.begin(), good_new_eles.end());
-		res[1].insert(res[1].end(), bad_new_eles.begin(), bad_new_eles.end());
-	}
-
-	string out = "";
-
-	for (string each : res[0]) {
-		out += each + ", ";
-	}
-
-	for (string each : res[1]) {
-		out += "Not " + each + ", ";
-	}
-
-	if (out == "") {
-		out = "None";
-	}
-	else {
-		out = out.substr(0, out.length() - 2);
-	}
-
-	return "Destination. Valid Destinations: " + out;*/
 }
 
 //Handles departure list menu and menu items
@@ -1818,7 +1354,7 @@ void CVFPCPlugin::OnFunctionCall(int FunctionId, const char * ItemString, POINT
 
 //Gets flight plan, checks if (S/D)VFR, calls checking algorithms, and outputs pass/fail result to departure list item
 void CVFPCPlugin::OnGetTagItem(CFlightPlan FlightPlan, CRadarTarget RadarTarget, int ItemCode, int TagData, char sItemString[16], int* pColorCode, COLORREF* pRGB, double* pFontSize){
-	if (validVersion && ItemCode == TAG_ITEM_FPCHECK && airports.find(FlightPlan.GetFlightPlanData().GetOrigin()) != airports.end()) {
+	if (validVersion && ItemCode == TAG_ITEM_FPCHECK && readRules(uiRules)->find(FlightPlan.GetFlightPlanData().GetOrigin()) != nullptr) {
 		string FlightPlanString = FlightPlan.GetFlightPlanData().GetRoute();
 		int RFL = FlightPlan.GetFlightPlanData().GetFinalAltitude();
 
@@ -1829,17 +1365,48 @@ void CVFPCPlugin::OnGetTagItem(CFlightPlan FlightPlan, CRadarTarget RadarTarget,
 			strcpy_s(sItemString, 16, "VFR");
 		}
 		else {
-			vector<vector<string>> validize = validizeSid(FlightPlan);
-			vector<string> messageBuffer{ validize[0] }; // 0 = Callsign, 1 = SID, 2 = Destination, 3 = Route, 4 = Nav Performance, 5 = Min/Max Flight Level, 6 = Even/Odd, 7 = Suffix, 8 = Aircraft Type, 9 = Date/Time, 10 = Syntax, 11 = Passed/Failed
+			collectCheckResults();
+
+			string callsign = FlightPlan.GetCallsign();
+			CachedVerdict& verdict = verdicts[callsign];
+			unsigned int generation = uiRules->generation;
+			int timeKey = getTimeKey();
+			bool amended = dirtyPlans.erase(callsign) > 0;
+			// Only results that evaluated a date/time restriction (or are still pending) can change with the minute
+			bool retime = verdict.timeKey != timeKey && (!verdict.valid || verdict.timed);
+
+			// Only look at the flight plan again if it was amended, or the rules/time changed since the last check
+			if (!verdict.requested || amended || verdict.generation != generation || retime) {
+				FlightPlanSnapshot plan = getSnapshot(FlightPlan);
+				size_t fingerprint = getFingerprint(plan);
+
+				// Amendments that don't touch any checked field (squawk, scratchpad, etc.) keep the previous result
+				if (!verdict.requested || verdict.fingerprint != fingerprint || verdict.generation != generation || retime) {
+					verdict.requested = true;
+					verdict.fingerprint = fingerprint;
+					verdict.generation = generation;
+					verdict.timeKey = timeKey;
+
+					queueCheck(plan, verdict);
+				}
+			}
 
-			if (messageBuffer.back() == "Passed") {
+			// Previous result (if any) stays on display until the worker publishes the new one
+			if (!verdict.valid) {
+				*pColorCode = TAG_COLOR_DEFAULT;
+				strcpy_s(sItemString, 16, "...");
+			}
+			else if (verdict.passed) {
 				*pRGB = TAG_GREEN;
 				strcpy_s(sItemString, 16, "OK!");
 			}
+			else if (verdict.fails.size()) {
+				*pRGB = TAG_RED;
+				strcpy_s(sItemString, 16, verdict.fails[failPos % verdict.fails.size()]);
+			}
 			else {
 				*pRGB = TAG_RED;
-				string code = getFails(validize[0]);
-				strcpy_s(sItemString, 16, code.c_str());
+				strcpy_s(sItemString, 16, "");
 			}
 		}
 
@@ -1859,6 +1426,7 @@ bool CVFPCPlugin::OnCompileCommand(const char * sCommandLine) {
 			fileLoad = false;
 			autoLoad = true;
 			relCount = 0;
+			dropValidators = true;
 			sendMessage("Auto-Load Activated.");
 			debugMessage("Info", "Auto-load reactivated.");
 		}
@@ -1869,6 +1437,7 @@ bool CVFPCPlugin::OnCompileCommand(const char * sCommandLine) {
 	{
 		autoLoad = false;
 		fileLoad = true;
+		dropValidators = true;
 		sendMessage("Attempting to load from Sid.json file.");
 		debugMessage("Info", "Will now load from Sid.json file.");
 		getSids();
@@ -1882,9 +1451,24 @@ bool CVFPCPlugin::OnCompileCommand(const char * sCommandLine) {
 		} else {
 			debugMode = true;
 			debugMessage("Info", "Logging mode activated.");
+			if (!HttpClient::decodesCompression()) {
+				debugMessage("Info", "libcurl was built without zlib, so downloads are not compressed.");
+			}
 		}
 		return true;
 	}
+	//Switch between the streaming and DOM loaders, applied from the next data load
+	else if (startsWith(".vfpc stream", sCommandLine)) {
+		streamLoad = !streamLoad;
+		sendMessage(streamLoad ? "Streaming loader activated." : "DOM loader activated.");
+		debugMessage("Info", streamLoad ? "Data will be compiled straight from the JSON stream." : "Data will be parsed into a DOM before compiling.");
+		return true;
+	}
+	//Convert Sid.json into a snapshot and compare loading both
+	else if (startsWith(".vfpc snapshot", sCommandLine)) {
+		convertSnapshot();
+		return true;
+	}
 	//Text-Equivalent of "Show Checks" Button
 	else if (startsWith(".vfpc check", sCommandLine))
 	{
@@ -1905,7 +1489,8 @@ void CVFPCPlugin::checkFPDetail() {
 			debugMessage(FlightPlan.GetCallsign(), buf);
 		}
 		else {
-			vector<vector<string>> validize = validizeSid(FlightPlanSelectASEL());
+			FlightPlanSnapshot plan = getSnapshot(FlightPlanSelectASEL());
+			vector<vector<string>> validize = renderCheck(plan, validizeSid(plan, readRules(uiRules)));
 			vector<string> messageBuffer{ validize[0] }; // 0 = Callsign, 1 = SID, 2 = Destination, 3 = Route, 4 = Nav Performance, 5 = Min/Max Flight Level, 6 = Even/Odd, 7 = Suffix, 8 = Aircraft Type, 9 = Date/Time, 10 = Syntax, 11 = Passed/Failed
 			vector<string> logBuffer{ validize[1] }; // 0 = Callsign, 1 = SID, 2 = Destination, 3 = Route, 4 = Nav Performance, 5 = Min/Max Flight Level, 6 = Even/Odd, 7 = Suffix, 8 = Aircraft Type, 9 = Date/Time, 10 = Syntax, 11 = Passed/Failed
 			sendMessage(messageBuffer.front(), "Checking...");
@@ -1940,46 +1525,183 @@ void CVFPCPlugin::checkFPDetail() {
 }
 
 //Compiles list of failed elements in flight plan, in preparation for adding to departure list
-string CVFPCPlugin::getFails(vector<string> messageBuffer) {
-	vector<string> fail;
+vector<const char*> CVFPCPlugin::getFails(const CheckResult& result) {
+	return checkFails(result);
+}
 
-	if (messageBuffer.at(1).find("Invalid") == 0) {
-		fail.push_back("SID");
-	}
-	if (messageBuffer.at(2).find("Failed") == 0) {
-		fail.push_back("DST");
-	}
-	if (messageBuffer.at(3).find("Failed") == 0) {
-		fail.push_back("RTE");
-	}
-	if (messageBuffer.at(4).find("Failed") == 0) {
-		fail.push_back("NAV");
+//Copies the flight plan fields read by validizeSid
+FlightPlanSnapshot CVFPCPlugin::getSnapshot(CFlightPlan flightPlan) {
+	FlightPlanSnapshot plan;
+	CFlightPlanData data = flightPlan.GetFlightPlanData();
+
+	plan.callsign = flightPlan.GetCallsign();
+	plan.origin = data.GetOrigin();
+	plan.destination = data.GetDestination();
+	plan.route = data.GetRoute();
+	plan.finalAltitude = data.GetFinalAltitude();
+	plan.sidName = data.GetSidName();
+	plan.aircraftType = data.GetAircraftType();
+	plan.engineType = data.GetEngineType();
+	plan.capabilities = data.GetCapibilities();
+	plan.planType = data.GetPlanType();
+
+	CFlightPlanExtractedRoute extracted = flightPlan.GetExtractedRoute();
+	for (int i = 0; i < extracted.GetPointsNumber(); i++) {
+		plan.points.push_back(extracted.GetPointName(i));
 	}
-	if (messageBuffer.at(5).find("Failed") == 0) {
-		fail.push_back("MIN");
-		fail.push_back("MAX");
+
+	return plan;
+}
+
+//Hashes every flight plan field read by validizeSid
+size_t CVFPCPlugin::getFingerprint(const FlightPlanSnapshot& plan) {
+	size_t seed = 0;
+
+	boost::hash_combine(seed, plan.origin);
+	boost::hash_combine(seed, plan.destination);
+	boost::hash_combine(seed, plan.route);
+	boost::hash_combine(seed, plan.finalAltitude);
+	boost::hash_combine(seed, plan.sidName);
+	boost::hash_combine(seed, plan.aircraftType);
+	boost::hash_combine(seed, plan.engineType);
+	boost::hash_combine(seed, plan.planType);
+	boost::hash_combine(seed, plan.points);
+
+	return seed;
+}
+
+//Hands a flight plan to the worker thread, replacing any older queued copy
+void CVFPCPlugin::queueCheck(const FlightPlanSnapshot& plan, const CachedVerdict& key) {
+	{
+		lock_guard<mutex> lock(checkMutex);
+		CheckJob& job = checkQueue[plan.callsign];
+		job.plan = plan;
+		job.key = key;
 	}
-	if (messageBuffer.at(6).find("Failed") == 0) {
-		fail.push_back("DIR");
+	checkSignal.notify_one();
+}
+
+//Moves results published by the worker thread into the tag cache
+void CVFPCPlugin::collectCheckResults() {
+	if (!checkResultsReady.load()) {
+		return;
 	}
-	if (messageBuffer.at(7).find("Invalid") == 0) {
-		fail.push_back("SUF");
+
+	vector<pair<string, CachedVerdict>> results;
+	{
+		lock_guard<mutex> lock(checkMutex);
+		results.swap(checkResults);
+		checkResultsReady = false;
 	}
-	if (messageBuffer.at(8).find("Failed") == 0) {
-		fail.push_back("RST");
+
+	for (const pair<string, CachedVerdict>& each : results) {
+		unordered_map<string, CachedVerdict>::iterator it = verdicts.find(each.first);
+
+		// Drop results for disconnected plans, or for plans amended again since they were queued
+		if (it == verdicts.end() || it->second.fingerprint != each.second.fingerprint || it->second.generation != each.second.generation || it->second.timeKey != each.second.timeKey) {
+			continue;
+		}
+
+		it->second.valid = true;
+		it->second.passed = each.second.passed;
+		it->second.timed = each.second.timed;
+		it->second.fails = each.second.fails;
 	}
-	if (messageBuffer.at(messageBuffer.size() - 2).find("Invalid") == 0) {
-		fail.push_back("CHK");
+}
+
+//Worker thread - checks queued flight plans and publishes the results
+void CVFPCPlugin::runCheckWorker() {
+	std::shared_ptr<const SidRuleset> workerRules;
+	unique_lock<mutex> lock(checkMutex);
+
+	while (true) {
+		checkSignal.wait(lock, [this] { return stopWorker || !checkQueue.empty(); });
+
+		if (stopWorker) {
+			return;
+		}
+
+		CheckJob job = checkQueue.begin()->second;
+		checkQueue.erase(checkQueue.begin());
+		lock.unlock();
+
+		CheckResult check = validizeSid(job.plan, readRules(workerRules));
+
+		CachedVerdict result = job.key;
+		result.valid = true;
+		result.passed = check.passed;
+		result.timed = check.sidFails[2] || check.restFails[2];
+		result.fails = result.passed ? vector<const char*>() : getFails(check);
+
+		lock.lock();
+		checkResults.push_back(pair<string, CachedVerdict>(job.plan.callsign, result));
+		checkResultsReady = true;
 	}
+}
+
+//Europe/London minute of the week used by restriction checks
+int CVFPCPlugin::getTimeKey() {
+	return londonMinuteOfWeek(time(nullptr));
+}
+
+//Flight plan amended by pilot - re-check on next tag refresh
+void CVFPCPlugin::OnFlightPlanFlightPlanDataUpdate(CFlightPlan FlightPlan) {
+	dirtyPlans.insert(FlightPlan.GetCallsign());
+}
+
+//Controller data (SID, cleared level, etc.) amended - re-check on next tag refresh
+void CVFPCPlugin::OnFlightPlanControllerAssignedDataUpdate(CFlightPlan FlightPlan, int DataType) {
+	dirtyPlans.insert(FlightPlan.GetCallsign());
+}
+
+//Flight plan gone - forget its result
+void CVFPCPlugin::OnFlightPlanDisconnect(CFlightPlan FlightPlan) {
+	verdicts.erase(FlightPlan.GetCallsign());
+	dirtyPlans.erase(FlightPlan.GetCallsign());
 
-	return fail[failPos % fail.size()];
+	lock_guard<mutex> lock(checkMutex);
+	checkQueue.erase(FlightPlan.GetCallsign());
 }
 
-//Runs all web/file calls at once
+//Runs all web/file calls at once. Web calls are made in parallel and each is handled as soon as it completes.
 void CVFPCPlugin::runWebCalls() {
-	validVersion = versionCall();
-	timeCall();
-	getSids();
+	vector<HttpRequest> requests;
+
+	requests.push_back(webRequest(MY_API_ADDRESS "version"));
+	requests.back().done = [this](HttpRequest& request) {
+		validVersion = versionCall(request);
+	};
+
+	//Local time is computed from the system clock, the time server only checks it
+	if (debugMode) {
+		requests.push_back(webRequest("http://worldtimeapi.org/api/timezone/Europe/London"));
+		requests.back().done = [this](HttpRequest& request) {
+			timeCall(request);
+		};
+	}
+
+	bool apiLoad = autoLoad;
+	if (apiLoad) {
+		{
+			lock_guard<mutex> lock(loadMutex);
+			requests.push_back(sidRequest());
+		}
+		requests.back().done = [this](HttpRequest& request) {
+			getSids(&request);
+		};
+	}
+
+	http.getAll(requests);
+
+	bool refetch = false;
+	{
+		lock_guard<mutex> lock(loadMutex);
+		swap(refetch, refetchSids);
+	}
+
+	if (!apiLoad || refetch) {
+		getSids();
+	}
 }
 
 //Runs once per second, when EuroScope clock updates
@@ -2011,8 +1733,12 @@ void CVFPCPlugin::OnTimer(int Counter) {
 			relCount--;
 		}
 		else if (GetConnectionType() == CONNECTION_TYPE_NO) {
-			airports.clear();
-			config.Clear();
+			//Rules and validators are kept, so reconnecting can use them straight away and only download changes
+			verdicts.clear();
+			dirtyPlans.clear();
+
+			lock_guard<mutex> lock(checkMutex);
+			checkQueue.clear();
 		}
 	}
 }
\ No newline at end of file
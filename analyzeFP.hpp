@@ -3,22 +3,39 @@
 #include <sstream>
 #include <iostream>
 #include <string>
-#include <regex>
 #include "Constant.hpp"
 #include <fstream>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
 #include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
+#include <boost/container_hash/hash.hpp>
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
+#include "Ruleset.hpp"
+#include "RulesetSnapshot.hpp"
+#include "FlightPlanSnapshot.hpp"
+#include "RouteParser.hpp"
+#include "CheckResult.hpp"
+#include "FlightPlanCheck.hpp"
+#include "HttpClient.hpp"
+#include "LondonTime.hpp"
 
 #define MY_PLUGIN_NAME      "VFPC (UK)"
 #define MY_PLUGIN_VERSION   "3.4.0"
 #define MY_PLUGIN_DEVELOPER "Lenny Colton, Jan Fries, Hendrik Peter, Sven Czarnian"
 #define MY_PLUGIN_COPYRIGHT "GPL v3"
 #define MY_PLUGIN_VIEW_AVISO  "VATSIM (UK) Flight Plan Checker"
+#ifndef MY_API_ADDRESS
 #define MY_API_ADDRESS	"https://vfpc.tomjmills.co.uk/"
+#endif
 
 #define PLUGIN_WELCOME_MESSAGE	"Welcome to the (UK) VATSIM Flight Plan Checker"
 
@@ -27,6 +44,43 @@ using namespace boost;
 using namespace rapidjson;
 using namespace EuroScopePlugIn;
 
+//Last tag result for a flight plan, reused until it is amended or the rules/time change
+struct CachedVerdict {
+	bool requested = false;	//A check has been queued for the fingerprint/generation/timeKey below
+	size_t fingerprint = 0;
+	unsigned int generation = 0;
+	int timeKey = 0;
+
+	bool valid = false;		//A result has been published by the worker thread
+	bool passed = false;
+	bool timed = false;		//A date/time restriction was evaluated, so the result may change with timeKey
+	vector<const char*> fails;	//Tag codes of failed checks
+};
+
+//SID data being loaded. Parsed in-situ, so strings point into text (or the downloaded body), everything else is allocated from pool.
+//With the streaming loader, text is compiled straight into rules and doc and pool stay empty.
+struct SidData {
+	string text;
+	MemoryPoolAllocator<> pool;
+	Document doc;
+	bool stream;
+	std::shared_ptr<SidRuleset> rules;	//Compiled data, empty until parsed or if parsing failed
+	string error;						//Parse error and its byte offset, if parsing failed
+	size_t errorOffset;
+	string source;						//File or URL parsed, its length and how long parsing and compiling took
+	size_t length;
+	double parseMs;
+
+	//block is used as the pool's first chunk, further chunks are only allocated if it is full
+	SidData(vector<char>& block, bool stream) : pool(&block[0], block.size()), doc(&pool), stream(stream), rules(std::make_shared<SidRuleset>()), errorOffset(0), length(0), parseMs(0) {}
+};
+
+//Flight plan waiting to be checked on the worker thread
+struct CheckJob {
+	FlightPlanSnapshot plan;
+	CachedVerdict key;
+};
+
 class CVFPCPlugin :
 	public EuroScopePlugIn::CPlugIn
 {
@@ -34,35 +88,71 @@ public:
 	CVFPCPlugin();
 	virtual ~CVFPCPlugin();
 
-	virtual bool webCall(string url, string& out);
+	virtual HttpRequest webRequest(string url, HttpValidators* validators = nullptr);
+
+	virtual HttpRequest sidRequest();
+
+	virtual bool webResult(HttpRequest& request, HttpValidators* validators = nullptr);
+
+	virtual bool timeCall(HttpRequest& request);
+
+	virtual bool APICall(HttpRequest& request, SidData& data, HttpValidators* validators = nullptr);
+
+	virtual bool versionCall(HttpRequest& request);
+
+	virtual string pluginFile(string name);
+
+	virtual bool parseJson(Document& out, string& text, const string& source);
+
+	virtual bool parseJson(Document& out, char* text, size_t length, const string& source);
 
-	virtual bool timeCall();
+	virtual bool parseSids(SidData& data, char* text, size_t length, const string& source);
 
-	virtual bool APICall(string endpoint, Document& out);
+	virtual bool cacheCall(SidData& data);
 
-	virtual bool versionCall();
+	virtual bool saveCache(const HttpRequest& request);
 
-	virtual bool fileCall(Document &out);
+	virtual void commitCache();
 
-	virtual void getSids();
+	virtual bool snapshotCall(SidRuleset& out);
 
-	virtual vector<vector<string>> validizeSid(CFlightPlan flightPlan);
+	virtual void saveSnapshot(const SidRuleset& rules);
 
-	virtual string AlternativesOutput(size_t origin_int, size_t pos, vector<size_t> successes = {});
+	virtual void convertSnapshot();
 
-	virtual string RestrictionsOutput(size_t origin_int, size_t pos, bool type, bool time, vector<size_t> successes = {});
+	virtual bool fileCall(SidData& data);
 
-	virtual string SuffixOutput(size_t origin_int, size_t pos, vector<size_t> successes = {});
+	virtual vector<char>& getParseBlock();
 
-	virtual string DirectionOutput(size_t origin_int, size_t pos, vector<size_t> successes);
+	virtual void finishLoad(SidData& data);
 
-	virtual string MinMaxOutput(size_t origin_int, size_t pos, vector<size_t> successes);
+	virtual void getSids(HttpRequest* request = nullptr);
 
-	virtual string NavPerfOutput(size_t origin_int, size_t pos, vector< size_t> successes);
+	virtual void publishRules(std::shared_ptr<SidRuleset> next);
 
-	virtual string RouteOutput(size_t origin_int, size_t pos, vector<size_t> successes, vector<string> extracted_route);
+	virtual const std::shared_ptr<const SidRuleset>& readRules(std::shared_ptr<const SidRuleset>& held);
 
-	virtual string DestinationOutput(size_t origin_int, string dest);
+	virtual CheckResult validizeSid(const FlightPlanSnapshot& flightPlan, const std::shared_ptr<const SidRuleset>& ruleset);
+
+	virtual vector<vector<string>> renderCheck(const FlightPlanSnapshot& flightPlan, const CheckResult& result);
+
+	virtual void splitSid(const AirportRules& airport, const string& sidName, string& sid, string& first_wp, string& sid_suffix);
+
+	virtual string AlternativesOutput(const SidRule& sid_ele, vector<size_t> successes = {});
+
+	virtual string RestrictionsOutput(const SidRule& sid_ele, bool type, bool time, vector<size_t> successes = {});
+
+	virtual string SuffixOutput(const SidRule& sid_ele, vector<size_t> successes = {});
+
+	virtual string DirectionOutput(const SidRule& sid_ele, vector<size_t> successes);
+
+	virtual string MinMaxOutput(const SidRule& sid_ele, vector<size_t> successes);
+
+	virtual string NavPerfOutput(const SidRule& sid_ele, vector< size_t> successes);
+
+	virtual string RouteOutput(const SidRule& sid_ele, vector<size_t> successes, const WaypointIds& extracted_route);
+
+	virtual string DestinationOutput(const AirportRules& airport, string dest);
 
 	//virtual string EngineOutput(size_t origin_int, size_t pos, vector<int> successes);
 
@@ -95,96 +185,6 @@ public:
 		return elems;
 	}
 
-	string destArrayContains(const Value& a, string s) {
-		for (SizeType i = 0; i < a.Size(); i++) {
-			string test = a[i].GetString();
-			SizeType x = static_cast<rapidjson::SizeType>(s.rfind(test, 0));
-			if (s.rfind(a[i].GetString(), 0) != -1)
-				return a[i].GetString();
-		}
-		return "";
-	}
-
-	bool arrayContains(const Value& a, string s) {
-		for (SizeType i = 0; i < a.Size(); i++) {
-			if (a[i].GetString() == s)
-				return true;
-		}
-		return false;
-	}
-
-	bool arrayContainsEnding(const Value& a, string s) {
-		for (SizeType i = 0; i < a.Size(); i++) {
-			string comp = a[i].GetString();
-			int pos = s.size() - comp.size();
-			if (pos < 0)
-				continue;
-
-			bool valid = true;
-
-			for (SizeType i = 0; i < comp.size(); i++) {
-				if (comp[i] != s[pos + i])
-					valid = false;
-			}
-
-			if (valid)
-				return true;
-			
-		}
-		return false;
-	}
-
-	bool arrayContains(const Value& a, char s) {
-		for (SizeType i = 0; i < a.Size(); i++) {
-			if (a[i].GetString()[0] == s)
-				return true;
-		}
-		return false;
-	}
-
-	string arrayToString(const Value& a, char delimiter) {
-		string s;
-		for (SizeType i = 0; i < a.Size(); i++) {
-			s += a[i].GetString()[0];
-			if (i != a.Size() - 1)
-				s += delimiter;
-		}
-		return s;
-	}
-
-	bool routeContains(string cs, vector<string> rte, const Value& valid) {
-		for (SizeType i = 0; i < valid.Size(); i++) {
-			string r = valid[i].GetString();
-
-			if (r == "*") {
-				return true;
-			}
-
-			vector<string> current = split(r, ' ');
-			for (std::size_t j = 0; j < current.size(); j++) {
-				boost::to_upper(current[j]);
-			}
-
-			bool admissible = true;
-
-			if (current.size() > rte.size()) {
-				admissible = false;
-			}
-			else {
-				for (SizeType j = 0; j < current.size(); j++) {
-					if (current[j] != rte[j] && current[j] != "*") {
-						admissible = false;
-					}
-				}
-			}
-
-			if (admissible) {
-				return true;
-			}
-		}
-		return false;
-	}
-
 	string dayIntToString(int day) {
 		switch (day) {
 		case 0:
@@ -216,14 +216,53 @@ public:
 
 	virtual void checkFPDetail();
 
-	virtual string getFails(vector<string> messageBuffer);
+	virtual vector<const char*> getFails(const CheckResult& result);
+
+	virtual FlightPlanSnapshot getSnapshot(CFlightPlan flightPlan);
+
+	virtual size_t getFingerprint(const FlightPlanSnapshot& plan);
+
+	virtual void queueCheck(const FlightPlanSnapshot& plan, const CachedVerdict& key);
+
+	virtual void collectCheckResults();
+
+	virtual void runCheckWorker();
+
+	virtual int getTimeKey();
+
+	virtual void OnFlightPlanFlightPlanDataUpdate(CFlightPlan FlightPlan);
+
+	virtual void OnFlightPlanControllerAssignedDataUpdate(CFlightPlan FlightPlan, int DataType);
+
+	virtual void OnFlightPlanDisconnect(CFlightPlan FlightPlan);
 
 	virtual void runWebCalls();
 
 	virtual void OnTimer(int Count);
 
 protected:
-	Document config;
-	map<string, rapidjson::SizeType> airports;
+	HttpClient http;
+	HttpValidators configValidators;	//Only accessed while holding loadMutex once the plugin has started
+	atomic<bool> dropValidators;		//Set by commands on the EuroScope thread, the next API load clears configValidators
+	bool refetchSids;				//A 304 arrived for validators that were dropped, runWebCalls downloads again once its batch is done. Guarded by loadMutex
+	time_t configFetched;			//Download time of the data configValidators belong to
+	mutex loadMutex;				//Held while loading data, guards parseBlock
+	vector<char> parseBlock;		//Reused as the first pool chunk of every load
+	size_t parseBlockSize;			//Pool bytes the last load used, plus headroom
+
+	std::shared_ptr<const SidRuleset> publishedRules;	//Latest rules, only accessed through atomic_load/atomic_store
+	atomic<unsigned int> rulesGeneration;			//Generation of publishedRules, polled by readers instead of publishedRules itself
+	mutex publishMutex;								//Serialises loaders, never taken by readers
+	std::shared_ptr<const SidRuleset> uiRules;			//EuroScope thread's copy of publishedRules
+	unordered_map<string, CachedVerdict> verdicts;
+	unordered_set<string> dirtyPlans;
+
+	thread checkWorker;
+	mutex checkMutex;
+	condition_variable checkSignal;
+	bool stopWorker;
+	unordered_map<string, CheckJob> checkQueue;
+	vector<pair<string, CachedVerdict>> checkResults;
+	atomic<bool> checkResultsReady;
 };
 